@@ -22,6 +22,7 @@ auto &SerialStream = Phyllo::IO::USBSerial; // automatically chosen based on pla
 using LogicalStack = Phyllo::Protocol::Transport::MinimalLogicalStack;
 //using LogicalStack = Phyllo::Protocol::Transport::ReducedLogicalStack;
 //using LogicalStack = Phyllo::Protocol::Transport::StandardLogicalStack;
+//using LogicalStack = Phyllo::Protocol::Transport::AdaptiveLogicalStack;
 
 // Application Framework configuration:
 namespace Framework = Phyllo::Protocol::Application::PubSub;
@@ -15,15 +15,17 @@ namespace Framework = Phyllo::Protocol::Application::PubSub;
 // It is implmented as a basic example of how to write a basic single endpoint handler object
 class EchoHandler : public Framework::MsgPackSingleEndpointHandler {
   public:
+    static constexpr const char *topic() { return "echo"; } // for Framework::MsgPackHashRouter
+
     EchoHandler() :
-      Framework::MsgPackSingleEndpointHandler("echo") {}
+      Framework::MsgPackSingleEndpointHandler(topic()) {}
     EchoHandler(const ToSendDelegate &delegate) :
-      Framework::MsgPackSingleEndpointHandler("echo", delegate) {}
+      Framework::MsgPackSingleEndpointHandler(topic(), delegate) {}
 
     // Pub-Sub Node interface
 
     void endpointReceived(const EndpointDocument &document) {
-      send(document); // this just sends the document directly
+      send(document); // this just sends the received document's buffer back out
     }
 };
 
@@ -31,10 +33,12 @@ class EchoHandler : public Framework::MsgPackSingleEndpointHandler {
 // It is implmented as a basic example of how to write a basic single endpoint handler object
 class CopyHandler : public Framework::MsgPackSingleEndpointHandler {
   public:
+    static constexpr const char *topic() { return "copy"; } // for Framework::MsgPackHashRouter
+
     CopyHandler() :
-      Framework::MsgPackSingleEndpointHandler("copy") {}
+      Framework::MsgPackSingleEndpointHandler(topic()) {}
     CopyHandler(const ToSendDelegate &delegate) :
-      Framework::MsgPackSingleEndpointHandler("copy", delegate) {}
+      Framework::MsgPackSingleEndpointHandler(topic(), delegate) {}
 
     // Pub-Sub Node interface
 
@@ -47,10 +51,12 @@ class CopyHandler : public Framework::MsgPackSingleEndpointHandler {
 // It is implmented as a basic example of how to write a basic single endpoint handler object
 class ReplyHandler : public Framework::MsgPackSingleEndpointHandler {
   public:
+    static constexpr const char *topic() { return "reply"; } // for Framework::MsgPackHashRouter
+
     ReplyHandler() :
-      Framework::MsgPackSingleEndpointHandler("reply") {}
+      Framework::MsgPackSingleEndpointHandler(topic()) {}
     ReplyHandler(const ToSendDelegate &delegate) :
-      Framework::MsgPackSingleEndpointHandler("reply", delegate) {}
+      Framework::MsgPackSingleEndpointHandler(topic(), delegate) {}
 
     // Event loop interface
 
@@ -66,17 +72,19 @@ class ReplyHandler : public Framework::MsgPackSingleEndpointHandler {
     }
 
   protected:
-    EndpointDocument replyDocument;
+    SendDocument replyDocument;
 };
 
 // String prefix handling works on a single endpoint, so it's handled by a single endpoint handler object
 // It is implemented as an example of how to write a handler which receives and sends basic structs
 class StringPrefixHandler : public Framework::MsgPackSingleEndpointHandler {
   public:
+    static constexpr const char *topic() { return "prefix"; } // for Framework::MsgPackHashRouter
+
     StringPrefixHandler() :
-      Framework::MsgPackSingleEndpointHandler("prefix") {}
+      Framework::MsgPackSingleEndpointHandler(topic()) {}
     StringPrefixHandler(const ToSendDelegate &delegate) :
-      Framework::MsgPackSingleEndpointHandler("prefix", delegate) {}
+      Framework::MsgPackSingleEndpointHandler(topic(), delegate) {}
 
     // Pub-Sub Node interface
 
@@ -84,7 +92,7 @@ class StringPrefixHandler : public Framework::MsgPackSingleEndpointHandler {
       Request request;
       if (!document.reader.readClassAs(request)) return;
 
-      EndpointDocument responseDocument;
+      SendDocument responseDocument;
       Response response(request);
       response.responseString.append(request.prefixString.data(), request.prefixString.size());
       response.responseString.append(request.rootString.data(), request.rootString.size());
@@ -95,8 +103,8 @@ class StringPrefixHandler : public Framework::MsgPackSingleEndpointHandler {
   protected:
     struct Request {
       static const Phyllo::Protocol::Presentation::SerializationFormatCode kFormat = 0x80;
-      using MessageReader = ToReceive::Reader;
-      using MessageWriter = ToReceive::Writer;
+      using MessageReader = SendDocument::Reader;
+      using MessageWriter = SendDocument::Writer;
 
       Phyllo::StringView rootString;
       Phyllo::StringView prefixString;
@@ -123,7 +131,7 @@ class StringPrefixHandler : public Framework::MsgPackSingleEndpointHandler {
 
     struct Response {
       static const Phyllo::Protocol::Presentation::SerializationFormatCode kFormat = 0x81;
-      using MessageWriter = ToReceive::Writer;
+      using MessageWriter = SendDocument::Writer;
 
       Response(const Request &request) :
         request(request) {}
@@ -148,12 +156,14 @@ class StringPrefixHandler : public Framework::MsgPackSingleEndpointHandler {
 // also has its own event-loop behavior
 class BlinkHandler : public Framework::MsgPackSingleEndpointHandler {
   public:
+    static constexpr const char *topic() { return "blink"; } // for Framework::MsgPackHashRouter
+
     BlinkHandler() :
-      Framework::MsgPackSingleEndpointHandler("blink"),
+      Framework::MsgPackSingleEndpointHandler(topic()),
       blinkTimer(100),
       updateTimer(0) {}
     BlinkHandler(const ToSendDelegate &delegate) :
-      Framework::MsgPackSingleEndpointHandler("blink", delegate),
+      Framework::MsgPackSingleEndpointHandler(topic(), delegate),
       blinkTimer(100),
       updateTimer(5000) {}
 
@@ -179,7 +189,7 @@ class BlinkHandler : public Framework::MsgPackSingleEndpointHandler {
       blinkTimer.reset(); // start the timer for blinking
       updateTimer.start(); // start the update timer
 
-      EndpointDocument blinkDocument;
+      SendDocument blinkDocument;
       blinkDocument.header.schema = Phyllo::Protocol::Presentation::Schema::Generic::Primitive::Boolean;
       blinkDocument.writer.writeAs(blinkTimer.enabled); // this sends a document which is just a bool for whether the led is blinking
       send(blinkDocument);
@@ -214,7 +224,7 @@ class PingPongHandler : public Framework::MsgPackEndpointHandler {
       auto pingReceived = pingEndpoint.receive(document);
       if (!pingReceived) return;
 
-      EndpointDocument pongDocument;
+      SendDocument pongDocument;
       pongDocument.header.schema = Phyllo::Protocol::Presentation::Schema::Generic::Primitive::Uint64;
       pongDocument.writer.writeAs(counter); // this sends a document which is just a counter of the number of pings received
       pongEndpoint.send(pongDocument);
@@ -21,6 +21,7 @@ auto &SerialStream = Phyllo::IO::USBSerial; // automatically chosen based on pla
 using LogicalStack = Phyllo::Protocol::Transport::MinimalLogicalStack;
 //using LogicalStack = Phyllo::Protocol::Transport::ReducedLogicalStack;
 //using LogicalStack = Phyllo::Protocol::Transport::StandardLogicalStack;
+//using LogicalStack = Phyllo::Protocol::Transport::AdaptiveLogicalStack;
 
 // Application Framework configuration:
 namespace Framework = Phyllo::Protocol::Application::PubSub;
@@ -44,6 +45,9 @@ PingPongHandler pingPongHandler;
 // Add handlers to the router:
 using Router = Framework::MsgPackRouter<>; // Give router the capacity to hold up to 256 handlers (default capacity)
 //using Router = Framework::MsgPackRouter<512>; // Give router the capacity to hold up to 512 handlers, or any arbitrary number you specify
+//using Router = Framework::MsgPackTopicRouter<>; // Dispatch each document only to the handlers for its topic, for applications with many handlers
+//using Router = Framework::MsgPackHashRouter<EchoHandler, CopyHandler, ReplyHandler, StringPrefixHandler, BlinkHandler>; // Dispatch through a perfect hash of single-topic handlers, computed at compile time (leave out pingPongHandler below)
+//using Router = Framework::MsgPackStaticRouter<EchoHandler, CopyHandler, ReplyHandler, StringPrefixHandler, BlinkHandler, PingPongHandler>; // Own the handlers and call them without virtual dispatch (declare it as just "Router router;" below)
 Router router(
   echoHandler,
   copyHandler,
@@ -68,9 +72,10 @@ void setup()
   // Serial communication & application protocol stack: setup
   Phyllo::IO::startSerial(SerialStream); // TODO: move this into communication stack if possible
   fullStack.setup();
+  //communicationStack.application.scheduler.conflate("blink"); // While the link is busy, hold only the newest blink state instead of queueing every one
 }
 
 void loop() {
   fullStack.update();
-  fullStack.receive();
+  fullStack.dispatch(); // or fullStack.receive() for a copy of the received document
 }
\ No newline at end of file
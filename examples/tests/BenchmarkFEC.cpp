@@ -0,0 +1,182 @@
+// Benchmark goodput of forward error correction against pure ARQ over a simulated noisy link
+
+// Standard libraries
+#include <Arduino.h>
+
+// Third-party libraries
+#include <elapsedMillis.h>
+
+// Phyllo
+#include "Phyllo.h"
+
+
+// SIMULATED LINK
+// Two in-memory pipes connect a pair of transport stacks on the same board, flipping bits at a given bit error rate
+
+class NoisyPipe {
+  public:
+    static const size_t kCapacity = 1024;
+
+    size_t size() const {
+      return count;
+    }
+
+    bool push(uint8_t byte) {
+      if (count == kCapacity) return false;
+      buffer[(start + count) % kCapacity] = byte;
+      ++count;
+      return true;
+    }
+
+    int peek() const {
+      if (!count) return -1;
+      return buffer[start];
+    }
+
+    int pop() {
+      int byte = peek();
+      if (!count) return byte;
+      start = (start + 1) % kCapacity;
+      --count;
+      return byte;
+    }
+
+    void clear() {
+      start = 0;
+      count = 0;
+    }
+
+  protected:
+    uint8_t buffer[kCapacity];
+    size_t start = 0;
+    size_t count = 0;
+};
+
+class NoisyStream : public Stream {
+  public:
+    static long bitErrorsPerMillion;
+
+    NoisyStream(NoisyPipe &rx, NoisyPipe &tx) : rx(rx), tx(tx) {}
+
+    int available() {
+      return rx.size();
+    }
+    int read() {
+      return rx.pop();
+    }
+    int peek() {
+      return rx.peek();
+    }
+    size_t write(uint8_t byte) {
+      for (uint8_t bit = 0; bit < 8; ++bit) {
+        if (random(1000000) < bitErrorsPerMillion) byte ^= (1 << bit);
+      }
+      return tx.push(byte);
+    }
+    using Print::write;
+
+  protected:
+    NoisyPipe &rx;
+    NoisyPipe &tx;
+};
+
+long NoisyStream::bitErrorsPerMillion = 0;
+
+NoisyPipe hostToDevice;
+NoisyPipe deviceToHost;
+NoisyStream hostStream(deviceToHost, hostToDevice);
+NoisyStream deviceStream(hostToDevice, deviceToHost);
+
+template<typename LogicalStack>
+class LinkPair {
+  public:
+    using TransportStack = Phyllo::Protocol::Transport::TransportStack<Phyllo::SerialMediumStack, LogicalStack>;
+
+    Phyllo::SerialMediumStack hostMedium;
+    Phyllo::SerialMediumStack deviceMedium;
+    LogicalStack hostLogical;
+    LogicalStack deviceLogical;
+    TransportStack host;
+    TransportStack device;
+
+    LinkPair() :
+      hostMedium(hostStream), deviceMedium(deviceStream),
+      hostLogical(hostMedium.sender), deviceLogical(deviceMedium.sender),
+      host(hostMedium, hostLogical), device(deviceMedium, deviceLogical) {}
+
+    void setup() {
+      host.setup();
+      device.setup();
+    }
+};
+
+
+// BENCHMARK
+
+static const size_t kPayloadSize = 64;
+static const unsigned int kPayloadCount = 500;
+static const unsigned long kSettleTimeout = 200; // ms without any new delivery before a run is considered finished
+static const long kBitErrorsPerMillion[] = {0, 10, 100, 300, 1000, 3000};
+
+template<typename LinkPair>
+void benchmark(const char *name, LinkPair &pair) {
+  uint8_t payload[kPayloadSize];
+  for (size_t i = 0; i < kPayloadSize; ++i) payload[i] = static_cast<uint8_t>(i + 1);
+
+  for (long bitErrorsPerMillion : kBitErrorsPerMillion) {
+    hostToDevice.clear();
+    deviceToHost.clear();
+    NoisyStream::bitErrorsPerMillion = bitErrorsPerMillion;
+
+    unsigned int sent = 0;
+    unsigned int delivered = 0;
+    elapsedMillis runTimer;
+    elapsedMillis settleTimer;
+    while (delivered < kPayloadCount && settleTimer < kSettleTimeout) {
+      pair.host.update();
+      pair.device.update();
+      if (sent < kPayloadCount && pair.host.top.send(Phyllo::ByteBufferView(payload, kPayloadSize))) ++sent;
+      pair.host.receive(); // process acknowledgements, if any
+      if (pair.device.receive()) {
+        ++delivered;
+        settleTimer = 0;
+      }
+      if (sent < kPayloadCount) settleTimer = 0;
+    }
+    unsigned long duration = runTimer - (delivered < kPayloadCount ? kSettleTimeout : 0);
+
+    Serial.print(name);
+    Serial.print(", BER (ppm): ");
+    Serial.print(bitErrorsPerMillion);
+    Serial.print(", delivered: ");
+    Serial.print(delivered);
+    Serial.print("/");
+    Serial.print(kPayloadCount);
+    Serial.print(", duration (ms): ");
+    Serial.print(duration);
+    Serial.print(", goodput (B/s): ");
+    Serial.println(duration ? delivered * kPayloadSize * 1000 / duration : 0);
+  }
+}
+
+LinkPair<Phyllo::Protocol::Transport::StandardLogicalStack> arqPair;
+LinkPair<Phyllo::Protocol::Transport::CorrectedLogicalStack> fecPair;
+
+
+// ARDUINO
+
+void setup()
+{
+  // Debugging setup
+  pinMode(LED_BUILTIN, OUTPUT);
+
+  // Results are reported over the default serial port
+  Phyllo::IO::startSerial(Serial, Phyllo::IO::kUSBSerialRate, true);
+  arqPair.setup();
+  fecPair.setup();
+
+  benchmark("ARQ (StandardLogicalStack)", arqPair);
+  benchmark("FEC (CorrectedLogicalStack)", fecPair);
+}
+
+void loop() {}
\ No newline at end of file
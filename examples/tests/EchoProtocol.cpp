@@ -31,6 +31,7 @@ static const long kUSBSerialRate = Phyllo::IO::kUSBSerialRate; // automatically
 using LogicalStack = Phyllo::Protocol::Transport::MinimalLogicalStack;
 //using LogicalStack = Phyllo::Protocol::Transport::ReducedLogicalStack;
 //using LogicalStack = Phyllo::Protocol::Transport::StandardLogicalStack;
+//using LogicalStack = Phyllo::Protocol::Transport::AdaptiveLogicalStack;
 
 // Application Stack configuration:
 //using ApplicationStack = Phyllo::Protocol::Application::MinimalStack;
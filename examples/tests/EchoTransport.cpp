@@ -34,6 +34,7 @@ using MediumStack = Phyllo::SerialMediumStack;
 using LogicalStack = Phyllo::Protocol::Transport::MinimalLogicalStack;
 //using LogicalStack = Phyllo::Protocol::Transport::ReducedLogicalStack;
 //using LogicalStack = Phyllo::Protocol::Transport::StandardLogicalStack;
+//using LogicalStack = Phyllo::Protocol::Transport::AdaptiveLogicalStack;
 
 
 // Communication transport stack automatically created:
@@ -35,21 +35,14 @@ StreamLink<Stream>::Receive StreamLink<Stream>::read() {
 }
 
 template<>
-bool StreamLink<Stream>::send(const ByteBufferView &buffer, uint8_t type) {
-  stream->write(buffer.data(), buffer.size());
-  return true;
+size_t StreamLink<Stream>::writable() {
+  int available = stream->availableForWrite();
+  return available > 0 ? available : 0;
 }
-template<>
-bool StreamLink<Stream>::send(const uint8_t *buffer, size_t size, uint8_t type) {
-  if (buffer == nullptr || !size) return false;
 
-  stream->write(buffer, size);
-  return true;
-}
 template<>
-bool StreamLink<Stream>::send(uint8_t byte, uint8_t type) {
-  stream->write(byte);
-  return true;
+size_t StreamLink<Stream>::write(const uint8_t *buffer, size_t size) {
+  return stream->write(buffer, size);
 }
 
 template<>
@@ -0,0 +1,262 @@
+#pragma once
+
+// Standard libraries
+#include <Arduino.h>
+
+// Third-party libraries
+#include <etl/delegate.h>
+
+// Phyllo
+#include "Phyllo/Types.h"
+#include "Phyllo/Util/Endian.h"
+#include "Phyllo/Util/Timing.h"
+#include "Phyllo/Protocol/Types.h"
+#include "Phyllo/Protocol/Transport/Stacks.h"
+#include "SerialLink.h"
+
+// Baud rate negotiation lets UART peers agree in-band on a faster data rate, and falls back if the new rate doesn't work
+
+#ifndef PHYLLO_SERIAL_RATE_MAX
+#define PHYLLO_SERIAL_RATE_MAX 1000000 // Fastest rate to accept from the peer; 1 Mbaud is exact for 16 MHz AVRs
+#endif
+
+namespace Phyllo { namespace IO {
+
+template<typename SerialClass>
+class BaudRateNegotiator {
+  public:
+    using ResultDelegate = etl::delegate<void(long, bool)>; // called with the rate in use and whether the switch succeeded
+    using FlushDelegate = etl::delegate<void()>; // hands any bytes queued above the UART to it
+
+    enum class State : uint8_t {
+      idle, // running at the committed rate
+      proposing, // waiting at the old rate for the peer to accept the new rate
+      verifying // exchanging test frames at the new rate
+    };
+
+    static const Protocol::DataUnitTypeCode kType = 0x09; // layer-defined minimal datagram type
+    static const long kMaxRate = PHYLLO_SERIAL_RATE_MAX;
+    static const unsigned long kResponseTimeout = 200; // ms to wait for the peer to accept a proposal
+    static const unsigned long kVerifyTimeout = 500; // ms at the new rate before deciding whether to keep it
+    static const unsigned long kVerifyInterval = 50; // ms between test frames from the proposer
+
+    BaudRateNegotiator(
+        SerialClass &serial, Protocol::Transport::MinimalLogicalStack &link,
+        long rate = kUSBSerialRate
+    ) :
+      serial(serial), link(link), defaultRate(rate), currentRate(rate), fallbackRate(rate),
+      responseTimer(kResponseTimeout), verifyTimer(kVerifyTimeout), retryTimer(kVerifyInterval) {
+        link.setLayerHandler(Protocol::Transport::MinimalLogicalStack::LayerDelegate::create<
+          BaudRateNegotiator, &BaudRateNegotiator::receive
+        >(*this));
+      }
+    BaudRateNegotiator(const BaudRateNegotiator &negotiator) = delete; // prevent accidental copy-by-value
+
+    // Event loop interface
+
+    void setup() {}
+
+    void update() {
+      switch (currentState) {
+        case State::proposing:
+          if (responseTimer.timedOut()) finish(false); // the peer didn't answer, so nothing changed
+          break;
+        case State::verifying:
+          if (verifyTimer.timedOut()) {
+            finish(verified);
+            break;
+          }
+          if (proposer && !verified && retryTimer.timedOut()) sendTestFrame(kVerify);
+          break;
+        default:
+          break;
+      }
+    }
+
+    // BaudRateNegotiator interface
+
+    bool propose(long rate) {
+      if (currentState != State::idle || rate <= 0 || rate > kMaxRate) return false;
+      if (rate == currentRate) return true;
+
+      proposer = true;
+      pendingRate = rate;
+      if (!sendRate(kPropose, rate)) return false;
+
+      currentState = State::proposing;
+      responseTimer.start();
+      return true;
+    }
+
+    long rate() const {
+      return currentRate;
+    }
+
+    State state() const {
+      return currentState;
+    }
+
+    unsigned long failureCount() const { // switches which fell back to the previous rate
+      return failures;
+    }
+
+    void fallback() { // return to the default rate, e.g. when the peer stops responding at a rate which was committed
+      if (currentRate != defaultRate) switchRate(defaultRate);
+      fallbackRate = defaultRate;
+      currentState = State::idle;
+      stopTimers();
+    }
+
+    void setResultHandler(const ResultDelegate &handler) {
+      this->handler = handler;
+    }
+
+    void setFlushHandler(const FlushDelegate &flusher) { // e.g. StreamMediumStack::flush, so its send queue goes out at the old rate
+      this->flusher = flusher;
+    }
+
+  protected:
+    enum Command : uint8_t {
+      kPropose = 0x01, // followed by the rate
+      kAccept = 0x02, // followed by the rate
+      kReject = 0x03, // followed by the rate
+      kVerify = 0x04, // followed by the test pattern
+      kConfirm = 0x05 // followed by the test pattern
+    };
+    static const size_t kRateSize = sizeof(uint32_t);
+    static const size_t kPatternSize = 8;
+
+    SerialClass &serial;
+    Protocol::Transport::MinimalLogicalStack &link;
+
+    State currentState = State::idle;
+    const long defaultRate;
+    long currentRate;
+    long fallbackRate;
+    long pendingRate = 0;
+    bool proposer = false;
+    bool verified = false;
+    unsigned long failures = 0;
+
+    Util::TimeoutTimer responseTimer;
+    Util::TimeoutTimer verifyTimer;
+    Util::TimeoutTimer retryTimer;
+
+    ResultDelegate handler;
+    FlushDelegate flusher;
+
+    static const uint8_t *pattern() {
+      // Alternating bits, long runs and the frame delimiter are the likeliest to be garbled at a marginal rate
+      static const uint8_t kPattern[kPatternSize] = {0x55, 0xaa, 0x00, 0xff, 0x0f, 0xf0, 0x33, 0xcc};
+      return kPattern;
+    }
+
+    bool receive(const Protocol::Transport::Datagram &datagram) {
+      if (datagram.header.type != kType) return false;
+
+      ByteBufferView payload = datagram.payload();
+      if (payload.empty()) return true;
+
+      switch (payload[0]) {
+        case kPropose:
+          receiveProposal(payload);
+          break;
+        case kAccept:
+          if (currentState != State::proposing || readRate(payload) != pendingRate) break;
+
+          startVerifying(pendingRate);
+          sendTestFrame(kVerify);
+          break;
+        case kReject:
+          if (currentState == State::proposing) finish(false);
+          break;
+        case kVerify:
+          if (currentState != State::verifying || proposer || !validTestFrame(payload)) break;
+
+          verified = true;
+          sendTestFrame(kConfirm); // reply to every test frame, in case some replies are lost
+          break;
+        case kConfirm:
+          if (currentState == State::verifying && proposer && validTestFrame(payload)) verified = true;
+          break;
+        default:
+          break;
+      }
+      return true;
+    }
+
+    void receiveProposal(const ByteBufferView &payload) {
+      long rate = readRate(payload);
+      if (currentState != State::idle || rate <= 0 || rate > kMaxRate) {
+        sendRate(kReject, rate);
+        return;
+      }
+
+      proposer = false;
+      sendRate(kAccept, rate);
+      startVerifying(rate); // the accept goes out at the old rate before switching
+    }
+
+    void startVerifying(long rate) {
+      fallbackRate = currentRate;
+      verified = false;
+      switchRate(rate);
+      currentState = State::verifying;
+      responseTimer.resetAndStop();
+      verifyTimer.start();
+      retryTimer.start();
+    }
+
+    void finish(bool success) {
+      // Each side decides when its own verification window closes, so both reach the same decision unless
+      // every reply in the window was lost
+      if (currentState == State::verifying && !success) {
+        switchRate(fallbackRate);
+        ++failures;
+      }
+      if (success) fallbackRate = currentRate;
+      currentState = State::idle;
+      stopTimers();
+      if (handler.is_valid()) handler(currentRate, success);
+    }
+
+    void switchRate(long rate) {
+      if (flusher.is_valid()) flusher();
+      serial.flush(); // finish sending at the old rate before reconfiguring the UART
+      serial.end();
+      serial.begin(rate);
+      currentRate = rate;
+    }
+
+    void stopTimers() {
+      responseTimer.resetAndStop();
+      verifyTimer.resetAndStop();
+      retryTimer.resetAndStop();
+    }
+
+    static long readRate(const ByteBufferView &payload) {
+      if (payload.size() < 1 + kRateSize) return 0;
+
+      return Util::readFromNetwork<uint32_t>(payload.data() + 1);
+    }
+
+    bool sendRate(uint8_t command, long rate) {
+      uint8_t payload[1 + kRateSize] = {command};
+      Util::writeToNetwork<uint32_t>(rate, payload + 1);
+      return link.send(ByteBufferView(payload, sizeof(payload)), kType);
+    }
+
+    bool validTestFrame(const ByteBufferView &payload) const {
+      // Minimal datagrams only check their length, so compare the whole pattern to catch corruption
+      return payload.size() == 1 + kPatternSize && memcmp(payload.data() + 1, pattern(), kPatternSize) == 0;
+    }
+
+    bool sendTestFrame(uint8_t command) {
+      uint8_t payload[1 + kPatternSize] = {command};
+      memcpy(payload + 1, pattern(), kPatternSize);
+      retryTimer.start();
+      return link.send(ByteBufferView(payload, sizeof(payload)), kType);
+    }
+};
+
+} }
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+// Standard libraries
+#include <Arduino.h>
+
+// Third-party libraries
+
+// Phyllo
+#include "Phyllo/Protocol/Transport/ByteStreamLink.h"
+
+// Byte Stream adapts a ByteStreamLink to the Arduino Stream interface, so that Stream-based code can tunnel over Phyllo
+
+namespace Phyllo { namespace IO {
+
+class ByteStream : public Stream {
+  public:
+    using Link = Protocol::Transport::ByteStreamLink;
+
+    Link &link;
+
+    ByteStream(Link &link) : link(link) {}
+    ByteStream(const ByteStream &stream) = delete; // prevent accidental copy-by-value
+
+    // Stream interface
+
+    int available() {
+      return link.available();
+    }
+
+    int read() {
+      return link.read();
+    }
+
+    int peek() {
+      return link.peek();
+    }
+
+    // Print interface
+
+    size_t write(uint8_t byte) {
+      return link.send(ByteBufferView(&byte, 1));
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) {
+      if (buffer == nullptr || !size) return 0;
+
+      return link.send(ByteBufferView(buffer, size));
+    }
+
+    int availableForWrite() {
+      return link.availableForWrite();
+    }
+
+    void flush() {
+      link.flush();
+    }
+
+    using Print::write; // for strings
+};
+
+} }
\ No newline at end of file
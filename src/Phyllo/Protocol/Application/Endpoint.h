@@ -8,21 +8,30 @@
 // Phyllo
 #include "Phyllo/Types.h"
 #include "Phyllo/Protocol/Presentation/Types.h"
+#include "Priority.h"
+#include "RateLimit.h"
 
 // Endpoints allow different objects to handle different documents depending on their respective named endpoints.
 
 namespace Phyllo { namespace Protocol { namespace Application {
 
 // NameFilter allows filtering documents by topic.
-// Topic filtering can be done by an exact match on the provided topic or a prefix match on the provided topic
+// Topic filtering can be done by an exact match on the provided topic or a prefix match on the provided topic.
+// Filters given as strings may also use hierarchical wildcards which fill a whole level between '/' separators:
+// '+' matches any one level, as in "motor/+/speed", and a final '#' matches any remaining levels, as in "log/#".
 
 class NameFilter {
   public:
+    static const uint8_t kLevelSeparator = '/';
+    static const uint8_t kSingleLevelWildcard = '+';
+    static const uint8_t kMultiLevelWildcard = '#';
+
     const ByteBufferView filter;
     uint8_t byteFilter;
+    const bool wildcard; // whether the filter has wildcards; single-byte filters never do
 
     NameFilter(uint8_t singleByteFilter) :
-      filter(ByteBufferView(&singleByteFilter, 1)), byteFilter(singleByteFilter) {}
+      filter(ByteBufferView(&singleByteFilter, 1)), byteFilter(singleByteFilter), wildcard(false) {}
     NameFilter(const char *filter) :
       NameFilter(StringView(filter)) {}
     template<typename ByteArray>
@@ -30,13 +39,15 @@ class NameFilter {
       filter(
         reinterpret_cast<const uint8_t *>(filter.begin()),
         reinterpret_cast<const uint8_t *>(filter.end())
-      ) {}
-    NameFilter(const ByteBufferView &filter) : filter(filter) {}
+      ), wildcard(hasWildcards(this->filter)) {}
+    NameFilter(const ByteBufferView &filter) : filter(filter), wildcard(hasWildcards(filter)) {}
     NameFilter(const NameFilter &filter) = delete; // prevent accidental copy-by-value
 
     // TopicFilter interface
 
     bool matches(const ByteBufferView &name) const {
+      if (wildcard) return matchesWildcards(name);
+
       return name == filter;
     }
 
@@ -52,23 +63,88 @@ class NameFilter {
 
       return ByteBufferView(name.begin() + filter.size(), name.end());
     }
+
+    // Wildcard interface
+
+    static uint8_t wildcardAt(const ByteBufferView &filter, size_t i) {
+      // Returns the wildcard filling the level which starts at i, or 0 if there is none, so "a+b" is matched literally
+      if (i >= filter.size() || (i > 0 && filter[i - 1] != kLevelSeparator)) return 0;
+
+      bool levelEnd = (i + 1 == filter.size());
+      if (filter[i] == kMultiLevelWildcard && levelEnd) return kMultiLevelWildcard;
+      if (filter[i] == kSingleLevelWildcard && (levelEnd || filter[i + 1] == kLevelSeparator)) return kSingleLevelWildcard;
+      return 0;
+    }
+
+    static bool hasWildcards(const ByteBufferView &filter) {
+      for (size_t i = 0; i < filter.size(); ++i) {
+        if (wildcardAt(filter, i)) return true;
+      }
+      return false;
+    }
+    static constexpr bool hasWildcards(const char *filter, bool levelStart = true) { // for checks at compile time
+      return *filter != '\0' && ((levelStart && wildcardLevel(filter)) || hasWildcards(filter + 1, *filter == kLevelSeparator));
+    }
+
+  protected:
+    static constexpr bool wildcardLevel(const char *level) { // matches wildcardAt for a level which starts here
+      return (
+        (*level == kMultiLevelWildcard && level[1] == '\0')
+        || (*level == kSingleLevelWildcard && (level[1] == '\0' || level[1] == kLevelSeparator))
+      );
+    }
+
+    bool matchesWildcards(const ByteBufferView &name) const {
+      size_t n = 0;
+      for (size_t f = 0; f < filter.size(); ++f) {
+        switch (wildcardAt(filter, f)) {
+          case kMultiLevelWildcard:
+            return true;
+          case kSingleLevelWildcard:
+            while (n < name.size() && name[n] != kLevelSeparator) ++n;
+            continue;
+          default:
+            break;
+        }
+        if (n < name.size() && name[n] == filter[f]) {
+          ++n;
+          continue;
+        }
+
+        // "log/#" also matches "log"
+        return n == name.size() && filter[f] == kLevelSeparator && wildcardAt(filter, f + 1) == kMultiLevelWildcard;
+      }
+      return n == name.size();
+    }
 };
 
-// TopicEndpoint allows receiving and sending documents on one Endpoint with an exact endpoint name match
+// TopicEndpoint allows receiving and sending documents on one Endpoint with an exact endpoint name match.
+// Derived provides getEndpointName, which is resolved at compile time (CRTP).
+// Documents are received as views of the received buffer, so handlers which only read a few fields copy nothing.
+// Documents are sent as the endpoint name with the serialized document, so the lower layers can send the
+// document's own buffer without first copying it into a ToSend. Each endpoint sends at its own priority class
+// unless a send names another one, and its sends are subject to its rate limit, if it has one and
+// PHYLLO_APPLICATION_RATE_LIMITS is set.
+// A wildcard filter names no single topic, so endpoints with one can only send on topics given with sendOn.
 
-template<typename Document, Presentation::SerializationFormatCode Format>
+template<typename DocumentView, Presentation::SerializationFormatCode Format, typename Derived>
 class Endpoint {
   public:
     using Name = ByteBufferView;
-    using ToReceive = Document; // The type of data passed up from below
-    using Receive = Presentation::Document<Format>; // The type of data passed up to above
+    using ToReceive = DocumentView; // The type of data passed up from below
+    using Receive = Presentation::DocumentView<Format>; // The type of data passed up to above
     using OptionalReceive = Util::Optional<Receive>;
     using Send = Presentation::Document<Format>;
+    using SendView = Presentation::DocumentView<Format>; // a Send, or a Receive to send back out
     using SendDelegate = etl::delegate<bool(const Send &)>;
-    using ToSend = Document; // The type of data passed down to below
-    using ToSendDelegate = etl::delegate<bool(const ToSend &)>;
+    using ToSend = DocumentView; // The type of data passed down to below, as a name and a SendView
+    using ToSendDelegate = etl::delegate<bool(const Name &, const SendView &, Priority)>;
 
     const NameFilter filter;
+    Priority priority = Priority::normal;
+#if PHYLLO_APPLICATION_RATE_LIMITS
+    RateLimit rateLimit;
+#endif
 
     template<typename Filter>
     Endpoint(const Filter &filter) :
@@ -80,20 +156,36 @@ class Endpoint {
 
     // Endpoint interface
 
-    virtual ByteBufferView getEndpointName(const ToReceive &document) const = 0;
-    virtual void prepareToSendDocument(ToSend &toSendDocument, const Send &sendDocument) const = 0;
-
     OptionalReceive receive(const ToReceive &document) {
       OptionalReceive received;
-      if (!filter.matches(getEndpointName(document))) return received;
+      if (!filter.matches(derived().getEndpointName(document))) return received;
       return document;
     }
-    bool send(const Send &sendDocument) {
+    bool send(const SendView &sendDocument) {
+      return send(sendDocument, priority);
+    }
+    bool send(const SendView &sendDocument, Priority sendPriority) {
+      if (filter.wildcard) return false; // e.g. "motor/+/speed" isn't a topic
+
+      return sendOn(filter.filter, sendDocument, sendPriority);
+    }
+    bool sendOn(const Name &topic, const SendView &sendDocument) {
+      return sendOn(topic, sendDocument, priority);
+    }
+    bool sendOn(const Name &topic, const SendView &sendDocument, Priority sendPriority) {
+      // The topic must be one which the endpoint's filter matches, e.g. "motor/1/speed" for "motor/+/speed"
       if (sender == nullptr) return false;
+      if (NameFilter::hasWildcards(topic) || !filter.matches(topic)) return false;
+#if PHYLLO_APPLICATION_RATE_LIMITS
+      if (!rateLimit.readyToSend()) return rateLimit.suppress();
 
-      Document toSendDocument;
-      prepareToSendDocument(toSendDocument, sendDocument);
-      return (*sender)(toSendDocument);
+      if (!(*sender)(topic, sendDocument, sendPriority)) return false;
+
+      rateLimit.sent(); // sends refused below don't use up the rate
+      return true;
+#else
+      return (*sender)(topic, sendDocument, sendPriority);
+#endif
     }
 
     void setToSendDelegate(const ToSendDelegate &delegate) {
@@ -101,7 +193,11 @@ class Endpoint {
     }
 
   protected:
-    const ToSendDelegate *sender;
+    const ToSendDelegate *sender = nullptr;
+
+    const Derived &derived() const {
+      return static_cast<const Derived &>(*this);
+    }
 };
 
 // EndpointHandler is an interface class for a unit of the application which
@@ -112,7 +208,8 @@ class EndpointHandler {
   public:
     using ToReceive = typename Endpoint::ToReceive; // The type of data passed up from below
     using ToSendDelegate = typename Endpoint::ToSendDelegate;
-    using EndpointDocument = typename Endpoint::Receive;
+    using EndpointDocument = typename Endpoint::Receive; // a view, which is only valid during receive
+    using SendDocument = typename Endpoint::Send;
 
     // Event loop interface
     virtual void setup() {}
@@ -132,6 +229,7 @@ class SingleEndpointHandler : public EndpointHandler<Endpoint> {
     using ToReceive = typename EndpointHandler<Endpoint>::ToReceive; // The type of data passed up from below
     using ToSendDelegate = typename EndpointHandler<Endpoint>::ToSendDelegate;
     using EndpointDocument = typename EndpointHandler<Endpoint>::EndpointDocument;
+    using SendDocument = typename EndpointHandler<Endpoint>::SendDocument;
 
     template<typename Filter>
     SingleEndpointHandler(const Filter &filter) :
@@ -157,9 +255,38 @@ class SingleEndpointHandler : public EndpointHandler<Endpoint> {
 
     virtual void endpointReceived(const EndpointDocument &document) {}
 
-    bool send(const EndpointDocument &document) {
+    bool send(const typename Endpoint::SendView &document) {
       return endpoint.send(document);
     }
+    bool send(const typename Endpoint::SendView &document, Priority priority) {
+      return endpoint.send(document, priority);
+    }
+    bool sendOn(const ByteBufferView &topic, const typename Endpoint::SendView &document) {
+      return endpoint.sendOn(topic, document);
+    }
+    bool sendOn(const ByteBufferView &topic, const typename Endpoint::SendView &document, Priority priority) {
+      return endpoint.sendOn(topic, document, priority);
+    }
+
+    void setPriority(Priority priority) { // the default priority class for the handler's sends
+      endpoint.priority = priority;
+    }
+
+#if PHYLLO_APPLICATION_RATE_LIMITS
+    void setRateLimit(
+      unsigned long messagesPerSecond, unsigned long burst = 1, RateLimit::Mode mode = RateLimit::Mode::drop
+    ) {
+      endpoint.rateLimit.set(messagesPerSecond, burst, mode);
+    }
+
+    unsigned long suppressedCount() const { // sends dropped or deferred by the rate limit
+      return endpoint.rateLimit.suppressedCount();
+    }
+#endif
+
+    const NameFilter &filter() const {
+      return endpoint.filter;
+    }
 
   protected:
     Endpoint endpoint;
@@ -0,0 +1,113 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libaries
+
+// Phyllo
+#include "Phyllo/Types.h"
+#include "Phyllo/Util/PerfectHash.h"
+#include "Endpoint.h"
+
+// Hash routers dispatch documents to a set of single-topic handlers which is fixed at compile time.
+
+namespace Phyllo { namespace Protocol { namespace Application {
+
+// HashRouter finds a perfect hash of its handlers' topics at compile time, into the smallest table it can (one slot
+// per handler for small sets). Dispatching a document then takes one hash of its topic, one comparison against the
+// only topic which could match, and one call into a function where the handler's endpointReceived is called
+// non-virtually and can be inlined.
+// Each handler type must declare its topic as static constexpr const char *topic(), and must handle only that
+// topic, as SingleEndpointHandlers do; handlers for several topics or for wildcard filters should use Router or
+// TopicRouter instead, since topics are compared literally here.
+
+constexpr bool hashRouterWildcards() {
+  return false;
+}
+template<typename... Topics>
+constexpr bool hashRouterWildcards(const char *topic, Topics... topics) { // whether any of the topics has wildcards
+  return NameFilter::hasWildcards(topic) || hashRouterWildcards(topics...);
+}
+
+template<typename Handler>
+class HashRouterEntry {
+  public:
+    Handler &handler;
+
+    HashRouterEntry(Handler &handler) : handler(handler) {}
+};
+
+template<typename Endpoint, typename... Handlers>
+class HashRouter : HashRouterEntry<Handlers>... {
+  public:
+    using ToReceive = typename Endpoint::ToReceive;
+    using ToSendDelegate = typename Endpoint::ToSendDelegate;
+
+    static const size_t kHandlers = sizeof...(Handlers);
+    static const bool kHandlersFit = kHandlers > 0 && kHandlers <= Util::kPerfectHashMaxTableSize;
+    static_assert(kHandlersFit, "Hash router needs between 1 and 64 handlers!");
+    static_assert(!hashRouterWildcards(Handlers::topic()...), "Hash router topics can't have wildcards - use TopicRouter instead!");
+
+    static constexpr size_t kTableSize = kHandlersFit ? Util::perfectHashTableSize(kHandlers, Handlers::topic()...) : 1;
+    static constexpr Util::PerfectHashCode kSeed = kHandlersFit ? Util::perfectHashSeed(
+      0, Util::kPerfectHashSeeds, kTableSize, Handlers::topic()...
+    ) : 0;
+    static_assert(kSeed != Util::kPerfectHashNoSeed, "No perfect hash was found for the handler topics - are they all distinct?");
+
+    HashRouter(Handlers&... handlers) : HashRouterEntry<Handlers>(handlers)... {}
+    HashRouter(const HashRouter &router) = delete; // prevent accidental copy-by-value
+
+    // Event loop interface
+
+    void setup() {
+      using expand_type = int[];
+      expand_type { 0, (entry<Handlers>().Handlers::setup(), 0)... };
+    }
+    void update() {
+      using expand_type = int[];
+      expand_type { 0, (entry<Handlers>().Handlers::update(), 0)... };
+    }
+
+    // Endpoint handler interface
+
+    void receive(const ToReceive &document) {
+      ByteBufferView name = Endpoint::documentName(document);
+      uint8_t index = kTable.indices[Util::perfectHash(name, kSeed) % kTableSize];
+      if (index == Util::kPerfectHashNoIndex) return;
+      if (!Util::perfectHashNameMatches(name, kTopics[index])) return; // the hash only rules out the other topics
+
+      kReceivers[index](*this, document);
+    }
+    void setToSendDelegate(const ToSendDelegate &delegate) {
+      using expand_type = int[];
+      expand_type { 0, (entry<Handlers>().Handlers::setToSendDelegate(delegate), 0)... };
+    }
+
+  protected:
+    using Receiver = void (*)(HashRouter &, const ToReceive &);
+
+    static constexpr Util::PerfectHashTable<kTableSize> kTable = Util::perfectHashTable<kTableSize>(
+      kSeed, Util::MakeIndexSequence<kTableSize>(), Handlers::topic()...
+    );
+    static constexpr const char *kTopics[kHandlers] = {Handlers::topic()...};
+    static constexpr Receiver kReceivers[kHandlers] = {&HashRouter::template receiveBy<Handlers>...};
+
+    template<typename Handler>
+    Handler &entry() {
+      return static_cast<HashRouterEntry<Handler> &>(*this).handler;
+    }
+
+    template<typename Handler>
+    static void receiveBy(HashRouter &router, const ToReceive &document) {
+      router.template entry<Handler>().Handler::endpointReceived(document);
+    }
+};
+
+template<typename Endpoint, typename... Handlers>
+constexpr Util::PerfectHashTable<HashRouter<Endpoint, Handlers...>::kTableSize> HashRouter<Endpoint, Handlers...>::kTable;
+template<typename Endpoint, typename... Handlers>
+constexpr const char *HashRouter<Endpoint, Handlers...>::kTopics[];
+template<typename Endpoint, typename... Handlers>
+constexpr typename HashRouter<Endpoint, Handlers...>::Receiver HashRouter<Endpoint, Handlers...>::kReceivers[];
+
+} } }
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libaries
+
+// Phyllo
+#include "Phyllo/Types.h"
+
+// Priority classes let publishers choose which outgoing documents go first when the link is busy.
+
+namespace Phyllo { namespace Protocol { namespace Application {
+
+enum class Priority : uint8_t {
+  control = 0, // e.g. command acknowledgements, which are sent before anything else
+  normal = 1,
+  bulk = 2 // e.g. logs and debug output, which are sent when nothing else is waiting
+};
+
+const size_t kPriorityClasses = 3;
+
+inline size_t priorityIndex(Priority priority) {
+  return static_cast<size_t>(priority);
+}
+
+} } }
\ No newline at end of file
@@ -40,6 +40,28 @@ class Document : public Presentation::Document<Format> {
     Binary16 messageTopic;
 };
 
+// DocumentView references the topic and document of a received message without copying them, so it is only valid
+// while the message's buffer is unchanged. Documents can also be viewed in place.
+
+template<Presentation::SerializationFormatCode Format>
+class DocumentView : public Presentation::DocumentView<Format> {
+  public:
+    DocumentView() {}
+    DocumentView(const Document<Format> &document) :
+      Presentation::DocumentView<Format>(document), messageTopic(document.topic()) {}
+
+    ByteBufferView topic() const {
+      return messageTopic;
+    }
+
+    void setTopic(const ByteBufferView &topic) {
+      messageTopic = topic;
+    }
+
+  protected:
+    ByteBufferView messageTopic;
+};
+
 } } } }
 
 namespace Phyllo {
@@ -56,5 +78,17 @@ template<Protocol::Presentation::SerializationFormatCode Format>
 Protocol::Presentation::SchemaCode getPayloadSchema(const Protocol::Application::PubSub::Document<Format> &document) {
     return document.header.schema;
 }
+template<Protocol::Presentation::SerializationFormatCode Format>
+ByteBufferView getTopic(const Protocol::Application::PubSub::DocumentView<Format> &document) {
+    return document.topic();
+}
+template<Protocol::Presentation::SerializationFormatCode Format>
+ByteBufferView getBody(const Protocol::Application::PubSub::DocumentView<Format> &document) {
+    return document.body();
+}
+template<Protocol::Presentation::SerializationFormatCode Format>
+Protocol::Presentation::SchemaCode getPayloadSchema(const Protocol::Application::PubSub::DocumentView<Format> &document) {
+    return document.header.schema;
+}
 
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 // Phyllo
 #include "Phyllo/Types.h"
 #include "Phyllo/Util/Optional.h"
+#include "Phyllo/Protocol/Application/Priority.h"
 #include "Message.h"
 #include "Document.h"
 
@@ -24,10 +25,13 @@ class DocumentLink {
     using ToReceive = ByteBufferView; // The type of data passed up from below
     using Receive = Document<Format>; // The type of data passed up to above
     using OptionalReceive = Util::Optional<Receive>;
+    using ReceiveView = DocumentView<Format>; // The type of data passed up to above without copying
+    using OptionalReceiveView = Util::Optional<ReceiveView>;
     using Send = Document<Format>;
-    using SendDelegate = etl::delegate<bool(const Send &)>;
+    using SendView = Presentation::DocumentView<Format>;
+    using SendDelegate = etl::delegate<bool(const Topic &, const SendView &, Priority)>; // sends the document's own buffer
     using ToSend = ByteBufferView; // The type of data passed down to below
-    using ToSendDelegate = etl::delegate<bool(const Topic &, const ToSend &, DataUnitTypeCode)>;
+    using ToSendDelegate = etl::delegate<bool(const Topic &, const ToSend &, DataUnitTypeCode, Priority)>;
 
     DocumentLink(const ToSendDelegate &delegate) : sender(delegate) {}
     DocumentLink(const DocumentLink &documentLink) = delete; // prevent accidental copy-by-value
@@ -47,35 +51,50 @@ class DocumentLink {
       received->setTopic(topic);
       return received;
     }
+    OptionalReceiveView receiveView(const ByteBufferView &topic, const ByteBufferView &buffer) {
+      // The view references the topic and buffer, which must outlive it
+      OptionalReceiveView received;
+      if (buffer.empty()) return received;
+
+      received.enabled = received->read(buffer); // TODO: handle errors
+      received->setTopic(topic);
+      return received;
+    }
 
     template<typename Class>
-    typename etl::enable_if<!etl::is_one_of<Class, Send, Presentation::Document<Format>, ByteBuffer, ByteBufferView>::value, bool>::type
-    send(const ByteBufferView &topic, Class &instance) {
+    typename etl::enable_if<!etl::is_one_of<Class, Send, ReceiveView, Presentation::Document<Format>, SendView, ByteBuffer, ByteBufferView>::value, bool>::type
+    send(const ByteBufferView &topic, Class &instance, Priority priority = Priority::normal) {
       Document<Format> document;
       document.header.schema = Class::kSchema;
       document.setTopic(topic);
       if (!document.write(instance)) return false; // TODO: errors in payload writing must propagate up to the document! MessageReader needs to return whether it succeeded at the end of parsing, and readClass needs to check for errors from the class method for reading
-      return send(document);
+      return send(document, priority);
     }
     template<typename Class>
-    typename etl::enable_if<!etl::is_one_of<Class, Send, Presentation::Document<Format>, ByteBuffer, ByteBufferView>::value, bool>::type
-    send(const ByteBufferView &topic, const Class &instance) {
-      return send(topic, static_cast<Class &>(instance));
+    typename etl::enable_if<!etl::is_one_of<Class, Send, ReceiveView, Presentation::Document<Format>, SendView, ByteBuffer, ByteBufferView>::value, bool>::type
+    send(const ByteBufferView &topic, const Class &instance, Priority priority = Priority::normal) {
+      return send(topic, static_cast<Class &>(instance), priority);
+    }
+    bool send(const ByteBufferView &topic, const Presentation::Document<Format> &document, Priority priority = Priority::normal) {
+      // The document's buffer is passed down as-is, without copying it and the topic into a Send
+      return sender(topic, document.buffer(), Send::kType, priority);
     }
-    bool send(const ByteBufferView &topic, const Presentation::Document<Format> &document) {
-      return sender(topic, document.buffer(), Send::kType);
+    bool send(const ByteBufferView &topic, const SendView &document, Priority priority = Priority::normal) {
+      // e.g. to forward a received document
+      return sender(topic, document.buffer(), Send::kType, priority);
     }
-    bool send(const Send &document) {
-      return sender(document.topic(), document.buffer(), Send::kType);
+    bool send(const Send &document, Priority priority = Priority::normal) {
+      return sender(document.topic(), document.buffer(), Send::kType, priority);
     }
     bool send(
       const ByteBufferView &topic, const ByteBufferView &body,
-      Presentation::SchemaCode schema = Presentation::Schema::Generic::Schemaless
+      Presentation::SchemaCode schema = Presentation::Schema::Generic::Schemaless,
+      Priority priority = Priority::normal
     ) {
       Send document;
       document.header.schema = schema;
       document.setTopic(topic);
-      return document.write(body) && send(document);
+      return document.write(body) && send(document, priority);
     }
 
   protected:
@@ -16,9 +16,9 @@ namespace Phyllo { namespace Protocol { namespace Application { namespace PubSub
 // TopicEndpoint allows receiving and sending documents on one topic with an exact match
 
 template<Presentation::SerializationFormatCode Format>
-class Endpoint : public Application::Endpoint<Document<Format>, Format> {
+class Endpoint : public Application::Endpoint<DocumentView<Format>, Format, Endpoint<Format>> {
   public:
-    using EndpointInterface = Application::Endpoint<Document<Format>, Format>;
+    using EndpointInterface = Application::Endpoint<DocumentView<Format>, Format, Endpoint<Format>>;
 
     template<typename Filter>
     Endpoint(const Filter &filter) :
@@ -31,15 +31,11 @@ class Endpoint : public Application::Endpoint<Document<Format>, Format> {
     // Endpoint interface
 
     ByteBufferView getEndpointName(const typename EndpointInterface::ToReceive &document) const {
-      return document.topic();
+      return documentName(document);
     }
 
-    void prepareToSendDocument(
-      typename EndpointInterface::ToSend &toSendDocument, // Application::PubSub::Document<Formt>
-      const typename EndpointInterface::Send &sendDocument // Prsentation::Document<Formt>
-    ) const {
-      toSendDocument.setTopic(this->filter.filter);
-      toSendDocument.read(sendDocument.buffer());
+    static ByteBufferView documentName(const typename EndpointInterface::ToReceive &document) { // for TopicRouter
+      return document.topic();
     }
 };
 
@@ -12,6 +12,7 @@
 #include "Phyllo/Util/Struct.h"
 #include "Phyllo/Protocol/Types.h"
 #include "Phyllo/Protocol/Transport/ReliableBufferLink.h"
+#include "TopicAliases.h"
 
 // Document layer handles document serialization and deserialization. Documents are anything which can be
 // represented in JSON: regular arrays (like Python lists or tuples), associative arrays (like Python dicts),
@@ -29,6 +30,11 @@ class MessageHeader {
 
     static const size_t kSize = TypeField::kSize + TopicLengthField::kSize;
 
+    // The topic length field also marks topic aliases
+    static const Length kBindingFlag = 0x40; // the topic follows an alias byte, and binds the topic to the alias
+    static const Length kAliasFlag = 0x80; // the low bits are an alias bound earlier, and no topic follows
+    static const Length kLengthMask = 0x3f;
+
     TypeField type = DataUnitType::Bytes::Buffer;
     TopicLengthField topicLength = 0;
 
@@ -55,18 +61,31 @@ class Message {
     static const size_t kHeaderSize = MessageHeader::kSize;
     static const size_t kFooterSize = 0;
     static const size_t kOverheadSize = kHeaderSize + kFooterSize;
-    static const size_t kTopicSizeLimit = 15;
+    static const size_t kTopicSizeLimit = TopicAliases::kTopicSizeLimit; // must fit in MessageHeader::kLengthMask
     static const size_t kBodySizeLimit = Transport::ReliableBuffer::kPayloadSizeLimit - kOverheadSize;
 
+    using Alias = TopicAliases::Alias;
+
     MessageHeader header;
 
     Message() {}
 
-    ByteBufferView topic() const {
-      return ByteBufferView(dumpBuffer.begin() + kHeaderSize, dumpBuffer.begin() + kHeaderSize + header.topicLength);
+    ByteBufferView topic() const { // empty for aliased messages
+      return ByteBufferView(dumpBuffer.begin() + topicOffset(), dumpBuffer.begin() + topicOffset() + getTopicLength());
     }
     ByteBufferView payload() const {
-      return ByteBufferView(dumpBuffer.begin() + kHeaderSize + header.topicLength, dumpBuffer.end() - kFooterSize);
+      return ByteBufferView(dumpBuffer.begin() + topicOffset() + getTopicLength(), dumpBuffer.end() - kFooterSize);
+    }
+    Alias alias() const { // the alias which the message carries or binds, if any
+      if (header.topicLength & MessageHeader::kAliasFlag) return header.topicLength & ~MessageHeader::kAliasFlag;
+      if (header.topicLength & MessageHeader::kBindingFlag) return dumpBuffer[kHeaderSize];
+      return TopicAliases::kNoAlias;
+    }
+    bool aliased() const {
+      return header.topicLength & MessageHeader::kAliasFlag;
+    }
+    bool binding() const {
+      return !aliased() && (header.topicLength & MessageHeader::kBindingFlag);
     }
     ByteBufferView buffer() const {
       return ByteBufferView(dumpBuffer);
@@ -82,8 +101,9 @@ class Message {
       if (!header.read(buffer)) return false;
       // Dump body and header into own buffer
       ByteBufferView body(buffer.begin() + kHeaderSize, buffer.end() - kFooterSize);
+      if (!dump(body)) return false;
 
-      return dump(body);
+      return topicOffset() + getTopicLength() <= getBodyLength() + kHeaderSize;
     }
 
     bool write(const ByteBufferView &topic, const ByteBufferView &payload) {
@@ -99,6 +119,32 @@ class Message {
       return header.write(dumpBuffer);
     }
 
+    bool writeBinding(Alias alias, const ByteBufferView &topic, const ByteBufferView &payload) {
+      // Write a payload with its topic, and bind the topic to an alias for later messages
+      if (payload.empty() || topic.empty()) return false;
+      if (1 + payload.size() + topic.size() > kBodySizeLimit) return false;
+      if (topic.size() > kTopicSizeLimit) return false;
+
+      dumpBuffer.resize(kOverheadSize + 1 + payload.size() + topic.size());
+      header.topicLength = MessageHeader::kBindingFlag | topic.size();
+      dumpBuffer[kHeaderSize] = alias;
+      memcpy(dumpBuffer.begin() + kHeaderSize + 1, topic.data(), topic.size());
+      memcpy(dumpBuffer.begin() + kHeaderSize + 1 + topic.size(), payload.data(), payload.size());
+      return header.write(dumpBuffer);
+    }
+
+    bool writeAliased(Alias alias, const ByteBufferView &payload) {
+      // Write a payload with an alias in place of its topic
+      if (payload.empty()) return false;
+      if (payload.size() > kBodySizeLimit) return false;
+      if (alias & MessageHeader::kAliasFlag) return false;
+
+      dumpBuffer.resize(kOverheadSize + payload.size());
+      header.topicLength = MessageHeader::kAliasFlag | alias;
+      memcpy(dumpBuffer.begin() + kHeaderSize, payload.data(), payload.size());
+      return header.write(dumpBuffer);
+    }
+
     Message &operator=(const Message &message) {
       header = message.header;
       dumpBuffer.resize(message.buffer().size());
@@ -121,13 +167,80 @@ class Message {
       return dumpBuffer.size() - kOverheadSize;
     }
     size_t getTopicLength() const {
-      return header.topicLength;
+      if (aliased()) return 0;
+
+      return header.topicLength & MessageHeader::kLengthMask;
+    }
+    size_t topicOffset() const {
+      return kHeaderSize + (binding() ? 1 : 0);
     }
     size_t getPayloadLength() const {
-      return getBodyLength() - header.topicLength;
+      return getBodyLength() - (topicOffset() - kHeaderSize) - getTopicLength();
     }
 };
 
+// MessageView references the topic and payload of a message in a received buffer without copying them, so it is
+// only valid while that buffer is unchanged. The topic of an aliased message can be set to a view of the topic
+// which its alias is bound to.
+
+class MessageView {
+  public:
+    static const DataUnitTypeCode kType = Message::kType;
+    static const size_t kHeaderSize = Message::kHeaderSize;
+    static const size_t kFooterSize = Message::kFooterSize;
+    static const size_t kOverheadSize = Message::kOverheadSize;
+
+    using Alias = Message::Alias;
+
+    MessageHeader header;
+
+    MessageView() {}
+
+    ByteBufferView topic() const { // empty for aliased messages until their topic is set
+      return messageTopic;
+    }
+    ByteBufferView payload() const {
+      return messagePayload;
+    }
+    Alias alias() const { // the alias which the message carries or binds, if any
+      if (header.topicLength & MessageHeader::kAliasFlag) return header.topicLength & ~MessageHeader::kAliasFlag;
+      if (header.topicLength & MessageHeader::kBindingFlag) return dumpView[kHeaderSize];
+      return TopicAliases::kNoAlias;
+    }
+    bool aliased() const {
+      return header.topicLength & MessageHeader::kAliasFlag;
+    }
+    bool binding() const {
+      return !aliased() && (header.topicLength & MessageHeader::kBindingFlag);
+    }
+    ByteBufferView buffer() const {
+      return dumpView;
+    }
+
+    bool read(const ByteBufferView &buffer) { // parse the header, and view the buffer without copying it
+      if (buffer.size() < kOverheadSize) return false; // TODO: handle this as an error signal
+      if (!header.read(buffer)) return false;
+
+      dumpView = buffer;
+      size_t topicOffset = kHeaderSize + (binding() ? 1 : 0);
+      size_t topicLength = aliased() ? 0 : (header.topicLength & MessageHeader::kLengthMask);
+      if (topicOffset + topicLength > buffer.size() - kFooterSize) return false;
+
+      messageTopic = ByteBufferView(buffer.begin() + topicOffset, buffer.begin() + topicOffset + topicLength);
+      messagePayload = ByteBufferView(buffer.begin() + topicOffset + topicLength, buffer.end() - kFooterSize);
+      return true;
+    }
+
+    void setTopic(const ByteBufferView &topic) {
+      messageTopic = topic;
+    }
+
+  protected:
+    ByteBufferView dumpView;
+    ByteBufferView messageTopic;
+    ByteBufferView messagePayload;
+};
+
 } } } }
 
 namespace Phyllo {
@@ -141,5 +254,14 @@ ByteBufferView getPayload(const Protocol::Application::PubSub::Message &message)
 Protocol::DataUnitTypeCode getPayloadType(const Protocol::Application::PubSub::Message &message) {
     return message.header.type;
 }
+ByteBufferView getTopic(const Protocol::Application::PubSub::MessageView &message) {
+    return message.topic();
+}
+ByteBufferView getPayload(const Protocol::Application::PubSub::MessageView &message) {
+    return message.payload();
+}
+Protocol::DataUnitTypeCode getPayloadType(const Protocol::Application::PubSub::MessageView &message) {
+    return message.header.type;
+}
 
 }
\ No newline at end of file
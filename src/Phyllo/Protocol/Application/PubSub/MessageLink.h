@@ -12,9 +12,13 @@
 #include "Phyllo/Protocol/Presentation/Document.h"
 #include "Phyllo/Protocol/Presentation/MessagePack.h"
 #include "Message.h"
+#include "TopicAliases.h"
 
 // Pub-Sub Messaging Framework associates payloads (such as serialized documents)
-// with independent named topics
+// with independent named topics. When topic aliasing is enabled, the first message on each topic binds it to a
+// 1-byte alias, and later messages on the topic carry only the alias. Peers refuse aliases beyond their own table,
+// e.g. because they were built with a smaller PHYLLO_APPLICATION_TOPIC_ALIASES or without aliasing, so the sender
+// sends those topics in full instead.
 
 namespace Phyllo { namespace Protocol { namespace Application { namespace PubSub {
 
@@ -23,6 +27,8 @@ class MessageLink {
     using ToReceive = ByteBufferView; // The type of data passed up from below
     using Receive = Message; // The type of data passed up to above
     using OptionalReceive = Util::Optional<Receive>;
+    using ReceiveView = MessageView; // The type of data passed up to above without copying
+    using OptionalReceiveView = Util::Optional<ReceiveView>;
     using Topic = ByteBufferView;
     using Send = ByteBufferView;
     using SendDelegate = etl::delegate<bool(const Topic &, const Send &, DataUnitTypeCode)>;
@@ -39,11 +45,27 @@ class MessageLink {
 
     // Named-topic Document Link interface
 
-    OptionalReceive receive(const ByteBufferView &buffer) {
+    OptionalReceive receive(const ByteBufferView &buffer) { // copies the message; receiveView doesn't
       OptionalReceive received;
+      auto viewed = receiveView(buffer);
+      if (!viewed) return received;
+
+      if (!viewed->aliased() && !viewed->binding()) {
+        received.enabled = received->read(buffer);
+        return received;
+      }
+
+      received->header.type = viewed->header.type;
+      received.enabled = received->write(viewed->topic(), viewed->payload()); // with its topic restored
+      return received;
+    }
+    OptionalReceiveView receiveView(const ByteBufferView &buffer) {
+      // The view references the buffer, or the topic bound to the message's alias
+      OptionalReceiveView received;
       if (buffer.empty()) return received;
 
       received.enabled = received->read(buffer);
+      if (received.enabled && (received->aliased() || received->binding())) received.enabled = resolveAlias(*received);
       return received;
     }
 
@@ -55,14 +77,97 @@ class MessageLink {
 
       Message message;
       message.header.type = type;
-      return message.write(topic, payload) && send(message);
+      Alias alias = outgoingAliases.enabled() ? outgoingAliases.find(topic) : TopicAliases::kNoAlias;
+      if (alias == TopicAliases::kNoAlias && outgoingAliases.enabled()) alias = outgoingAliases.add(topic);
+      if (alias == TopicAliases::kNoAlias) return message.write(topic, payload) && send(message);
+
+      if (outgoingAliases.bound(alias)) return message.writeAliased(alias, payload) && send(message);
+
+      if (!message.writeBinding(alias, topic, payload)) return message.write(topic, payload) && send(message);
+      if (!send(message)) return false;
+
+      outgoingAliases.setBound(alias, true); // if the binding is lost, the peer reports the alias as unknown
+      return true;
     }
     bool send(const Message &message) {
       return sender(message.buffer(), Message::kType);
     }
+    bool sendUrgent(
+      const ByteBufferView &topic, const ByteBufferView &payload,
+      DataUnitTypeCode type = DataUnitType::Bytes::Buffer
+    ) {
+      // Urgent messages may overtake earlier ones, so they carry their full topic instead of an alias which an
+      // overtaken message might bind; without an urgent sender, or if it refuses, they are sent like the others
+      if (!urgentSender.is_valid()) return send(topic, payload, type);
+
+      Message message;
+      message.header.type = type;
+      if (!message.write(topic, payload)) return false;
+      if (urgentSender(message.buffer(), Message::kType)) return true;
+
+      return send(topic, payload, type);
+    }
+
+    void setUrgentSender(const ToSendDelegate &delegate) { // e.g. a reliable link's sender which skips its queue
+      urgentSender = delegate;
+    }
+
+    void resetAliases() { // e.g. when the peer was reset, so both directions start over with full topics
+      outgoingAliases.clear();
+      incomingAliases.clear();
+    }
 
   protected:
+    using Alias = TopicAliases::Alias;
+
+    static const uint8_t kUnknownAlias = 0x01; // Control payload reporting an alias which isn't bound
+    static const uint8_t kRefusedAlias = 0x02; // Control payload reporting an alias which can't be bound
+
     const ToSendDelegate &sender;
+    ToSendDelegate urgentSender;
+
+    TopicAliases outgoingAliases;
+    TopicAliases incomingAliases;
+
+    bool resolveAlias(MessageView &message) {
+      // Returns whether the message should be passed up, with its topic restored
+      Alias alias = message.alias();
+      if (message.binding()) {
+        if (TopicAliases::storable(alias, message.topic())) incomingAliases.bind(alias, message.topic());
+        else report(alias, kRefusedAlias); // the message still carries its topic, so it is passed up
+        return true;
+      }
+
+      if (message.header.type == DataUnitType::Layer::Control) {
+        if (message.payload().empty()) return false;
+
+        switch (message.payload()[0]) {
+          case kUnknownAlias: // the peer lost the binding, so bind it again on its next use
+            outgoingAliases.setBound(alias, false);
+            break;
+          case kRefusedAlias: // the peer's table is too small, so send the topic in full from now on
+            outgoingAliases.refuse(alias);
+            break;
+        }
+        return false;
+      }
+
+      ByteBufferView topic = incomingAliases.topic(alias);
+      if (topic.empty()) {
+        report(alias, alias < TopicAliases::kSize ? kUnknownAlias : kRefusedAlias);
+        return false;
+      }
+
+      message.setTopic(topic); // a view of the alias table, which is only changed by bindings and resets
+      return true;
+    }
+
+    void report(Alias alias, uint8_t problem) {
+      Message report;
+      report.header.type = DataUnitType::Layer::Control;
+      const uint8_t payload[] = {problem};
+      if (report.writeAliased(alias, ByteBufferView(payload, sizeof(payload)))) send(report);
+    }
 };
 
 } } } }
\ No newline at end of file
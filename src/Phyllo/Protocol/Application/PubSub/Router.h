@@ -9,6 +9,9 @@
 // Phyllo
 #include "Phyllo/Types.h"
 #include "Phyllo/Protocol/Application/Router.h"
+#include "Phyllo/Protocol/Application/TopicRouter.h"
+#include "Phyllo/Protocol/Application/HashRouter.h"
+#include "Phyllo/Protocol/Application/StaticRouter.h"
 
 // Routers allow different objects to handle different documents depending on their respective named endpoints.
 
@@ -17,6 +20,21 @@ namespace Phyllo { namespace Protocol { namespace Application { namespace PubSub
 // Router allows automatic updating of endpoint handlers while the protocol stack is updated
 
 template<Presentation::SerializationFormatCode Format, size_t MaxHandlers = 127>
-using Router = Application::Router<Endpoint<Format>>;
+using Router = Application::Router<Endpoint<Format>, MaxHandlers>;
+
+// TopicRouter dispatches each document only to the handlers subscribed to its topic
+
+template<Presentation::SerializationFormatCode Format, size_t MaxHandlers = 64, size_t MaxNodes = 256>
+using TopicRouter = Application::TopicRouter<Endpoint<Format>, MaxHandlers, MaxNodes>;
+
+// HashRouter dispatches each document through a perfect hash of its handlers' topics, which is computed at compile time
+
+template<Presentation::SerializationFormatCode Format, typename... Handlers>
+using HashRouter = Application::HashRouter<Endpoint<Format>, Handlers...>;
+
+// StaticRouter owns a set of handlers fixed at compile time, and calls them without virtual dispatch
+
+template<Presentation::SerializationFormatCode Format, typename... Handlers>
+using StaticRouter = Application::StaticRouter<Endpoint<Format>, Handlers...>;
 
 } } } }
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libraries
+
+// Phyllo
+#include "Phyllo/Types.h"
+
+#ifndef PHYLLO_APPLICATION_TOPIC_ALIASES
+#define PHYLLO_APPLICATION_TOPIC_ALIASES 0 // Topics per direction which can be replaced by 1-byte aliases after their first use; 0 disables aliasing
+#endif
+
+// Topic aliases let messages carry a 1-byte alias instead of a topic which was bound to the alias earlier.
+// A peer with fewer aliases refuses bindings it can't store, and the sender then stops using those aliases.
+
+namespace Phyllo { namespace Protocol { namespace Application { namespace PubSub {
+
+class TopicAliases {
+  public:
+    using Alias = uint8_t;
+
+    static const size_t kSize = PHYLLO_APPLICATION_TOPIC_ALIASES;
+    static const size_t kTopicSizeLimit = 15;
+    static const Alias kNoAlias = 0xff;
+    static_assert(kSize <= 0x80, "At most 128 topic aliases are supported!");
+
+    static bool enabled() {
+      return kSize > 0;
+    }
+
+    // Sending interface
+
+    Alias find(const ByteBufferView &topic) const {
+      for (size_t i = 0; i < used && i < limit; ++i) {
+        if (entries[i].topic.size() == topic.size() && ByteBufferView(entries[i].topic) == topic) return i;
+      }
+      return kNoAlias;
+    }
+
+    Alias add(const ByteBufferView &topic) { // aliases are never reassigned, so later topics are sent in full once the table fills
+      if (used >= limit || topic.empty() || topic.size() > kTopicSizeLimit) return kNoAlias;
+
+      Entry &entry = entries[used];
+      entry.topic.resize(topic.size());
+      memcpy(entry.topic.data(), topic.data(), topic.size());
+      entry.bound = false;
+      return used++;
+    }
+
+    bool bound(Alias alias) const { // whether the peer has received the binding
+      return alias < used && entries[alias].bound;
+    }
+
+    void setBound(Alias alias, bool bound) { // cleared when the peer reports that it doesn't know the alias
+      if (alias < used) entries[alias].bound = bound;
+    }
+
+    void refuse(Alias alias) { // the peer can't store the alias, so it and every later alias go unused
+      if (alias < limit) limit = alias;
+    }
+
+    // Receiving interface
+
+    static bool storable(Alias alias, const ByteBufferView &topic) {
+      return alias < kSize && !topic.empty() && topic.size() <= kTopicSizeLimit;
+    }
+
+    void bind(Alias alias, const ByteBufferView &topic) {
+      if (!storable(alias, topic)) return;
+
+      Entry &entry = entries[alias];
+      entry.topic.resize(topic.size());
+      memcpy(entry.topic.data(), topic.data(), topic.size());
+      entry.bound = true;
+    }
+
+    ByteBufferView topic(Alias alias) const { // empty if the alias isn't bound
+      if (alias >= kSize || !entries[alias].bound) return ByteBufferView();
+
+      return ByteBufferView(entries[alias].topic);
+    }
+
+    void clear() {
+      for (size_t i = 0; i < kStorageSize; ++i) entries[i].bound = false;
+      used = 0;
+      limit = kSize;
+    }
+
+  protected:
+    static const size_t kStorageSize = (kSize > 0) ? kSize : 1;
+
+    struct Entry {
+      FixedByteBuffer<kTopicSizeLimit> topic;
+      bool bound = false;
+    };
+
+    Entry entries[kStorageSize];
+    size_t used = 0;
+    size_t limit = kSize; // aliases from here on were refused by the peer
+};
+
+} } } }
\ No newline at end of file
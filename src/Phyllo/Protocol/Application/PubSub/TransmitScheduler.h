@@ -0,0 +1,344 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libraries
+#include <etl/delegate.h>
+
+// Phyllo
+#include "Phyllo/Types.h"
+#include "Phyllo/Protocol/Types.h"
+#include "Phyllo/Protocol/Application/Priority.h"
+#include "Message.h"
+
+#ifndef PHYLLO_APPLICATION_CONTROL_QUEUE_SIZE
+#define PHYLLO_APPLICATION_CONTROL_QUEUE_SIZE 128 // bytes of control-priority messages held while the link is busy; 0 makes such sends fail instead
+#endif
+
+#ifndef PHYLLO_APPLICATION_NORMAL_QUEUE_SIZE
+#define PHYLLO_APPLICATION_NORMAL_QUEUE_SIZE 256 // bytes of normal-priority messages held while the link is busy; 0 makes such sends fail instead
+#endif
+
+#ifndef PHYLLO_APPLICATION_BULK_QUEUE_SIZE
+#define PHYLLO_APPLICATION_BULK_QUEUE_SIZE 256 // bytes of bulk-priority messages held while the link is busy; 0 makes such sends fail instead
+#endif
+
+#ifndef PHYLLO_APPLICATION_PRIORITY_WEIGHT
+#define PHYLLO_APPLICATION_PRIORITY_WEIGHT 0 // messages of higher priority sent while a lower class waits before it gets one; 0 drains strictly by priority
+#endif
+
+#ifndef PHYLLO_APPLICATION_CONFLATED_TOPICS
+#define PHYLLO_APPLICATION_CONFLATED_TOPICS 4 // state topics which can hold one pending latest value each while the link is busy; 0 disables conflation
+#endif
+
+#ifndef PHYLLO_APPLICATION_CONFLATED_PAYLOAD_SIZE
+#define PHYLLO_APPLICATION_CONFLATED_PAYLOAD_SIZE 32 // largest payload held for a conflated topic; larger ones, and newer ones behind them, are queued like other messages
+#endif
+
+// Transmit schedulers hold outgoing messages in one queue per priority class while the lower link is busy,
+// and send them in priority order as the link frees up.
+
+namespace Phyllo { namespace Protocol { namespace Application { namespace PubSub {
+
+// TransmitQueue is a FIFO of whole topic-payload pairs packed into a byte buffer
+
+class TransmitQueue {
+  public:
+    static const size_t kEntryOverhead = 3; // entry length, type, topic length
+    static const size_t kEntrySizeLimit = 0xff;
+
+    TransmitQueue(ByteBuffer &storage, size_t capacity) : storage(storage), capacity(capacity) {}
+
+    bool empty() const {
+      return cursor >= storage.size();
+    }
+
+    size_t size() const { // bytes queued, including overhead
+      return storage.size() - cursor;
+    }
+
+    bool fits(size_t topicSize, size_t payloadSize) const {
+      size_t entrySize = kEntryOverhead + topicSize + payloadSize;
+      return entrySize <= kEntrySizeLimit && entrySize <= capacity - size();
+    }
+
+    bool push(const ByteBufferView &topic, const ByteBufferView &payload, DataUnitTypeCode type) {
+      if (!fits(topic.size(), payload.size())) return false;
+
+      size_t entrySize = kEntryOverhead + topic.size() + payload.size();
+      if (storage.size() + entrySize > capacity) compact();
+      size_t end = storage.size();
+      storage.resize(end + entrySize);
+      storage[end] = entrySize;
+      storage[end + 1] = type;
+      storage[end + 2] = topic.size();
+      memcpy(storage.data() + end + kEntryOverhead, topic.data(), topic.size());
+      memcpy(storage.data() + end + kEntryOverhead + topic.size(), payload.data(), payload.size());
+      return true;
+    }
+
+    bool contains(const ByteBufferView &topic) const { // whether any entry has the topic
+      for (size_t entry = cursor; entry < storage.size(); entry += storage[entry]) {
+        if (storage[entry + 2] != topic.size()) continue;
+        if (ByteBufferView(storage.data() + entry + kEntryOverhead, topic.size()) == topic) return true;
+      }
+      return false;
+    }
+
+    // Front entry; only valid when the queue isn't empty
+
+    DataUnitTypeCode type() const {
+      return storage[cursor + 1];
+    }
+    ByteBufferView topic() const {
+      return ByteBufferView(storage.data() + cursor + kEntryOverhead, storage[cursor + 2]);
+    }
+    ByteBufferView payload() const {
+      size_t offset = kEntryOverhead + storage[cursor + 2];
+      return ByteBufferView(storage.data() + cursor + offset, storage[cursor] - offset);
+    }
+
+    void pop() {
+      cursor += storage[cursor];
+      if (!empty()) return;
+
+      clear();
+    }
+
+    void clear() {
+      storage.clear();
+      cursor = 0;
+    }
+
+  protected:
+    ByteBuffer &storage;
+    const size_t capacity;
+    size_t cursor = 0;
+
+    void compact() { // move the queued entries to the front to make room
+      size_t queued = size();
+      memmove(storage.data(), storage.data() + cursor, queued);
+      storage.resize(queued);
+      cursor = 0;
+    }
+};
+
+// TransmitScheduler passes each message straight down when nothing of the same or higher priority is waiting
+// and the lower link accepts it; otherwise the message waits in its class's queue. A failed send means that the
+// class's queue is full. Queues are drained in strict priority order, unless PHYLLO_APPLICATION_PRIORITY_WEIGHT is
+// set: then a waiting class gets one message through after that many messages of higher classes have passed it.
+// Since messages are queued before they get topic aliases, aliases are still bound in the order messages are sent.
+// Topics registered with conflate() are state topics, where only the newest value matters: while the link is busy,
+// each one holds a single pending value which newer sends overwrite, and which goes out before its class's queue.
+// So a state value is never staler than one drain of its class, however many samples were published meanwhile.
+// Values too large for the slot are queued instead, and so are newer values while one is queued, so that the slot
+// never sends a value ahead of an older one of the same topic.
+// Each message is passed down with its priority, so that the lower layers can expedite control messages.
+
+class TransmitScheduler {
+  public:
+    using Topic = ByteBufferView;
+    using Send = ByteBufferView;
+    using SendDelegate = etl::delegate<bool(const Topic &, const Send &, DataUnitTypeCode, Priority)>;
+    using ToSend = ByteBufferView; // The type of data passed down to below
+    using ToSendDelegate = etl::delegate<bool(const Topic &, const ToSend &, DataUnitTypeCode, Priority)>;
+
+    static const size_t kControlQueueSize = PHYLLO_APPLICATION_CONTROL_QUEUE_SIZE;
+    static const size_t kNormalQueueSize = PHYLLO_APPLICATION_NORMAL_QUEUE_SIZE;
+    static const size_t kBulkQueueSize = PHYLLO_APPLICATION_BULK_QUEUE_SIZE;
+    static const unsigned long kWeight = PHYLLO_APPLICATION_PRIORITY_WEIGHT;
+    static const size_t kConflatedTopics = PHYLLO_APPLICATION_CONFLATED_TOPICS;
+    static const size_t kConflatedPayloadSize = PHYLLO_APPLICATION_CONFLATED_PAYLOAD_SIZE;
+
+    TransmitScheduler(const ToSendDelegate &delegate) :
+      sender(delegate),
+      queues{
+        TransmitQueue(controlStorage, kControlQueueSize),
+        TransmitQueue(normalStorage, kNormalQueueSize),
+        TransmitQueue(bulkStorage, kBulkQueueSize)
+      } {}
+    TransmitScheduler(const TransmitScheduler &scheduler) = delete; // prevent accidental copy-by-value
+
+    // Event loop interface
+
+    void setup() {}
+    void update() {
+      drain();
+    }
+
+    // Transmit scheduler interface
+
+    bool send(
+      const ByteBufferView &topic, const ByteBufferView &payload,
+      DataUnitTypeCode type, Priority priority = Priority::normal
+    ) {
+      size_t index = priorityIndex(priority);
+      if (index >= kPriorityClasses || !fitsMessage(topic, payload)) return false; // it would block its queue forever
+
+      drain();
+      ConflatedSlot *slot = find(topic);
+      if (!waiting(index) && (slot == nullptr || !slot->pending) && sender(topic, payload, type, priority)) {
+        sent(index);
+        return true;
+      }
+
+      if (slot != nullptr && payload.size() <= kConflatedPayloadSize && !queues[index].contains(topic)) {
+        if (slot->pending) ++superseded;
+        slot->hold(payload, type, priority);
+        return true;
+      }
+      if (!queues[index].push(topic, payload, type)) {
+        ++blocked[index];
+        return false;
+      }
+      return true;
+    }
+
+    bool readyToSend(size_t topicSize, size_t payloadSize, Priority priority = Priority::normal) const {
+      // Whether a message of the class would be accepted now, so publishers can skip building it otherwise
+      size_t index = priorityIndex(priority);
+      return index < kPriorityClasses && queues[index].fits(topicSize, payloadSize);
+    }
+
+    bool conflate(const ByteBufferView &topic) {
+      // Registers a state topic, whose unsent values are replaced by newer ones instead of being queued
+      if (find(topic) != nullptr) return true;
+      if (conflatedCount >= kConflatedTopics || topic.empty() || topic.size() > Message::kTopicSizeLimit) return false;
+
+      ConflatedSlot &slot = slots[conflatedCount++];
+      slot.topic.resize(topic.size());
+      memcpy(slot.topic.data(), topic.data(), topic.size());
+      slot.pending = false;
+      return true;
+    }
+    bool conflate(const char *topic) {
+      return conflate(ByteBufferView(reinterpret_cast<const uint8_t *>(topic), strlen(topic)));
+    }
+
+    size_t queued(Priority priority) const { // bytes waiting in the class's queue
+      return queues[priorityIndex(priority)].size();
+    }
+
+    unsigned long blockedCount(Priority priority) const { // sends refused because the class's queue was full
+      return blocked[priorityIndex(priority)];
+    }
+
+    unsigned long supersededCount() const { // values of conflated topics which were replaced before being sent
+      return superseded;
+    }
+
+    void clear() { // e.g. when the peer was reset, so queued messages are stale
+      for (size_t i = 0; i < kPriorityClasses; ++i) {
+        queues[i].clear();
+        passed[i] = 0;
+      }
+      for (size_t i = 0; i < conflatedCount; ++i) slots[i].pending = false;
+    }
+
+  protected:
+    struct ConflatedSlot {
+      FixedByteBuffer<Message::kTopicSizeLimit> topic;
+      FixedByteBuffer<kConflatedPayloadSize> payload;
+      DataUnitTypeCode type = 0;
+      Priority priority = Priority::normal;
+      bool pending = false;
+
+      void hold(const ByteBufferView &value, DataUnitTypeCode valueType, Priority valuePriority) {
+        payload.resize(value.size());
+        memcpy(payload.data(), value.data(), value.size());
+        type = valueType;
+        priority = valuePriority;
+        pending = true;
+      }
+    };
+
+    const ToSendDelegate &sender;
+
+    FixedByteBuffer<kControlQueueSize ? kControlQueueSize : 1> controlStorage;
+    FixedByteBuffer<kNormalQueueSize ? kNormalQueueSize : 1> normalStorage;
+    FixedByteBuffer<kBulkQueueSize ? kBulkQueueSize : 1> bulkStorage;
+    TransmitQueue queues[kPriorityClasses];
+    unsigned long passed[kPriorityClasses] = {}; // messages sent from higher classes while each class waited
+    unsigned long blocked[kPriorityClasses] = {};
+    ConflatedSlot slots[kConflatedTopics ? kConflatedTopics : 1];
+    size_t conflatedCount = 0;
+    size_t nextSlot = 0; // where the search for a pending slot starts, so that every conflated topic gets its turn
+    unsigned long superseded = 0;
+
+    static bool fitsMessage(const ByteBufferView &topic, const ByteBufferView &payload) {
+      return !payload.empty() && topic.size() <= Message::kTopicSizeLimit
+        && topic.size() + payload.size() <= Message::kBodySizeLimit;
+    }
+
+    ConflatedSlot *find(const ByteBufferView &topic) {
+      for (size_t i = 0; i < conflatedCount; ++i) {
+        if (slots[i].topic.size() == topic.size() && ByteBufferView(slots[i].topic) == topic) return &slots[i];
+      }
+      return nullptr;
+    }
+
+    ConflatedSlot *pendingSlot(size_t index) {
+      for (size_t i = 0; i < conflatedCount; ++i) {
+        ConflatedSlot &slot = slots[(nextSlot + i) % conflatedCount];
+        if (slot.pending && priorityIndex(slot.priority) == index) return &slot;
+      }
+      return nullptr;
+    }
+
+    bool hasPending(size_t index) const {
+      for (size_t i = 0; i < conflatedCount; ++i) {
+        if (slots[i].pending && priorityIndex(slots[i].priority) == index) return true;
+      }
+      return false;
+    }
+
+    bool empty(size_t index) const {
+      return queues[index].empty() && !hasPending(index);
+    }
+
+    bool waiting(size_t index) const { // whether anything of the same or higher priority is queued
+      for (size_t i = 0; i <= index; ++i) {
+        if (!empty(i)) return true;
+      }
+      return false;
+    }
+
+    size_t next() const { // returns kPriorityClasses if nothing is queued
+      size_t highest = kPriorityClasses;
+      for (size_t i = 0; i < kPriorityClasses; ++i) {
+        if (empty(i)) continue;
+        if (kWeight && passed[i] >= kWeight) return i;
+        if (highest == kPriorityClasses) highest = i;
+      }
+      return highest;
+    }
+
+    void sent(size_t index) {
+      passed[index] = 0;
+      for (size_t i = index + 1; i < kPriorityClasses; ++i) {
+        if (!empty(i)) ++passed[i];
+      }
+    }
+
+    void drain() { // sends queued messages until the lower link refuses one
+      for (size_t index = next(); index < kPriorityClasses; index = next()) {
+        ConflatedSlot *slot = pendingSlot(index);
+        if (slot != nullptr) { // the freshest state values go before the class's queue
+          if (!sender(ByteBufferView(slot->topic), ByteBufferView(slot->payload), slot->type, slot->priority)) return;
+
+          slot->pending = false;
+          nextSlot = (slot - slots + 1) % conflatedCount;
+          sent(index);
+          continue;
+        }
+
+        TransmitQueue &queue = queues[index];
+        if (!sender(queue.topic(), queue.payload(), queue.type(), static_cast<Priority>(index))) return;
+
+        queue.pop();
+        sent(index);
+      }
+    }
+};
+
+} } } }
\ No newline at end of file
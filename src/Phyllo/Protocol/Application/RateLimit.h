@@ -0,0 +1,71 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libaries
+
+// Phyllo
+#include "Phyllo/Types.h"
+#include "Phyllo/Util/TokenBucket.h"
+
+#ifndef PHYLLO_APPLICATION_RATE_LIMITS
+#define PHYLLO_APPLICATION_RATE_LIMITS 1 // 0 removes rate limits from endpoints, to save RAM on every endpoint
+#endif
+
+// Rate limits cap how often an endpoint publishes, so that a fast publisher can't starve the other topics.
+
+namespace Phyllo { namespace Protocol { namespace Application {
+
+// RateLimit is a token bucket of messages. Publishes beyond the rate and burst are suppressed: in drop mode they
+// are discarded but reported as sent, for publishers which send every loop iteration without checking; in defer
+// mode they fail, so the publisher can retry them later, e.g. once readyToSend() is true.
+
+class RateLimit {
+  public:
+    enum class Mode : uint8_t {
+      drop = 0,
+      defer = 1
+    };
+
+    RateLimit() {}
+
+    // Rate limit interface
+
+    void set(unsigned long messagesPerSecond, unsigned long burst = 1, Mode mode = Mode::drop) {
+      // A rate of zero removes the limit
+      bucket = Util::TokenBucket(messagesPerSecond, burst ? burst : 1);
+      limitMode = mode;
+    }
+
+    bool limited() const {
+      return bucket.limited();
+    }
+
+    Mode mode() const {
+      return limitMode;
+    }
+
+    bool readyToSend() {
+      return bucket.available(1);
+    }
+
+    void sent() {
+      bucket.consume(1);
+    }
+
+    bool suppress() { // returns what the suppressed send should report
+      ++suppressed;
+      return limitMode == Mode::drop;
+    }
+
+    unsigned long suppressedCount() const { // publishes dropped or deferred
+      return suppressed;
+    }
+
+  protected:
+    Util::TokenBucket bucket;
+    Mode limitMode = Mode::drop;
+    unsigned long suppressed = 0;
+};
+
+} } }
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include "Phyllo/Protocol/Presentation/DocumentLink.h"
 #include "Phyllo/Protocol/Presentation/MessagePack.h"
 #include "PubSub/MessageLink.h"
+#include "PubSub/TransmitScheduler.h"
 #include "PubSub/DocumentLink.h"
 #include "PubSub/Endpoint.h"
 #include "PubSub/Router.h"
@@ -21,16 +22,24 @@ namespace Phyllo { namespace Protocol {
 
 namespace Presentation { namespace MsgPack {
   using Document = Presentation::Document<kFormat>;
+  using DocumentView = Presentation::DocumentView<kFormat>;
   using DocumentLink = Presentation::DocumentLink<kFormat>;
 } }
 
 namespace Application { namespace PubSub {
   using MsgPackDocumentLink = DocumentLink<Presentation::MsgPack::kFormat>;
+  using MsgPackDocumentView = DocumentView<Presentation::MsgPack::kFormat>;
   using MsgPackEndpoint = Endpoint<Presentation::MsgPack::kFormat>;
   using MsgPackEndpointHandler = EndpointHandler<Presentation::MsgPack::kFormat>;
   using MsgPackSingleEndpointHandler = SingleEndpointHandler<Presentation::MsgPack::kFormat>;
   template<size_t MaxHandlers = 256>
   using MsgPackRouter = Router<Presentation::MsgPack::kFormat, MaxHandlers>;
+  template<size_t MaxHandlers = 64, size_t MaxNodes = 256>
+  using MsgPackTopicRouter = TopicRouter<Presentation::MsgPack::kFormat, MaxHandlers, MaxNodes>;
+  template<typename... Handlers>
+  using MsgPackHashRouter = HashRouter<Presentation::MsgPack::kFormat, Handlers...>;
+  template<typename... Handlers>
+  using MsgPackStaticRouter = StaticRouter<Presentation::MsgPack::kFormat, Handlers...>;
 } }
 
 } }
@@ -87,12 +96,15 @@ class PubSubStack {
     using ToReceive = BottomLink::ToReceive; // The type of data passed up from below
     using Receive = TopLink::Receive; // The type of data passed up to above
     using OptionalReceive = TopLink::OptionalReceive;
+    using ReceiveView = TopLink::ReceiveView; // The type of data passed up to above without copying
+    using OptionalReceiveView = TopLink::OptionalReceiveView;
     using Send = TopLink::Send; // The type of data passed down from above
     using SendDelegate = TopLink::SendDelegate;
     using ToSend = BottomLink::ToSend; // The type of data passed down to below
     using ToSendDelegate = BottomLink::ToSendDelegate;
 
     PubSub::MessageLink message;
+    PubSub::TransmitScheduler scheduler;
     PubSub::MsgPackDocumentLink document;
 
     TopLink &top;
@@ -100,46 +112,72 @@ class PubSubStack {
     SendDelegate sender;
 
     PubSubStack(const ToSendDelegate &toSender) :
-      message(toSender), document(intermediateToSender),
+      message(toSender), scheduler(scheduledToSender), document(intermediateToSender),
       top(document), bottom(message),
       sender(SendDelegate::create<TopLink, &TopLink::send>(top)) {;
         intermediateToSender = IntermediateToSendDelegate::create<
           PubSubStack, &PubSubStack::toSend
         >(*this);
+        scheduledToSender = ScheduledToSendDelegate::create<
+          PubSubStack, &PubSubStack::toSendScheduled
+        >(*this);
       }
 
     // Event loop interface
 
     void setup() {
       message.setup();
+      scheduler.setup();
       document.setup();
     }
     void update() {
       message.update();
+      scheduler.update();
       document.update();
     }
 
     // Named-topic documentLink interface
 
     OptionalReceive receive(const ByteBufferView &buffer) {
-      auto messageReceived = message.receive(buffer);
+      auto messageReceived = message.receiveView(buffer);
       if (!messageReceived) return OptionalReceive();
 
       return document.receive(messageReceived->topic(), messageReceived->payload());
     }
+    OptionalReceiveView receiveView(const ByteBufferView &buffer) { // only valid while the buffer is unchanged
+      auto messageReceived = message.receiveView(buffer);
+      if (!messageReceived) return OptionalReceiveView();
+
+      return document.receiveView(messageReceived->topic(), messageReceived->payload());
+    }
 
     bool send(const Send &document) {
       return top.send(document);
     }
 
+    void setUrgentToSendDelegate(const ToSendDelegate &delegate) {
+      // Control-priority messages are passed to this delegate instead, e.g. so they skip the transport's queue
+      message.setUrgentSender(delegate);
+    }
+
   protected:
     using IntermediateToSendDelegate = PubSub::MsgPackDocumentLink::ToSendDelegate;
     IntermediateToSendDelegate intermediateToSender;
+    using ScheduledToSendDelegate = PubSub::TransmitScheduler::ToSendDelegate;
+    ScheduledToSendDelegate scheduledToSender;
 
     bool toSend(
       const ByteBufferView &topic, const PubSub::MsgPackDocumentLink::ToSend &body,
-      DataUnitTypeCode type
+      DataUnitTypeCode type, Priority priority
+    ) {
+      return scheduler.send(topic, body, type, priority);
+    }
+    bool toSendScheduled(
+      const ByteBufferView &topic, const PubSub::TransmitScheduler::ToSend &body,
+      DataUnitTypeCode type, Priority priority
     ) {
+      if (priority == Priority::control) return message.sendUrgent(topic, body, type);
+
       return message.send(topic, body, type);
     }
 };
@@ -0,0 +1,72 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libaries
+
+// Phyllo
+#include "Phyllo/Types.h"
+#include "Endpoint.h"
+
+// Static routers hold a set of handlers which is fixed at compile time, without pointers or virtual dispatch.
+
+namespace Phyllo { namespace Protocol { namespace Application {
+
+// StaticRouter owns one handler of each of its handler types, so it needs no pointer array. Every call into a
+// handler is qualified with the handler's type, and the compiler knows each handler's exact type, so the fan-out
+// in setup, update, receive and setToSendDelegate is resolved at compile time and can be inlined - including
+// the endpointReceived calls made by SingleEndpointHandlers.
+// Handlers must be default-constructible, and each handler type can appear only once; use get() to reach them.
+
+template<typename Handler>
+class StaticRouterEntry {
+  public:
+    Handler handler;
+};
+
+template<typename Endpoint, typename... Handlers>
+class StaticRouter : StaticRouterEntry<Handlers>... {
+  public:
+    using ToReceive = typename Endpoint::ToReceive;
+    using ToSendDelegate = typename Endpoint::ToSendDelegate;
+
+    static const size_t kHandlers = sizeof...(Handlers);
+
+    StaticRouter() {}
+    StaticRouter(const StaticRouter &router) = delete; // prevent accidental copy-by-value
+
+    // Event loop interface
+
+    void setup() {
+      using expand_type = int[];
+      expand_type { 0, (get<Handlers>().Handlers::setup(), 0)... };
+    }
+    void update() {
+      using expand_type = int[];
+      expand_type { 0, (get<Handlers>().Handlers::update(), 0)... };
+    }
+
+    // Endpoint handler interface
+
+    void receive(const ToReceive &document) {
+      using expand_type = int[];
+      expand_type { 0, (get<Handlers>().Handlers::receive(document), 0)... };
+    }
+    void setToSendDelegate(const ToSendDelegate &delegate) {
+      using expand_type = int[];
+      expand_type { 0, (get<Handlers>().Handlers::setToSendDelegate(delegate), 0)... };
+    }
+
+    // Static router interface
+
+    template<typename Handler>
+    Handler &get() {
+      return static_cast<StaticRouterEntry<Handler> &>(*this).handler;
+    }
+    template<typename Handler>
+    const Handler &get() const {
+      return static_cast<const StaticRouterEntry<Handler> &>(*this).handler;
+    }
+};
+
+} } }
\ No newline at end of file
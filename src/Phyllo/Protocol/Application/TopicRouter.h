@@ -0,0 +1,275 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libaries
+#include <etl/vector.h>
+
+// Phyllo
+#include "Phyllo/Types.h"
+#include "Endpoint.h"
+
+#ifndef PHYLLO_APPLICATION_WILDCARD_STATES
+#define PHYLLO_APPLICATION_WILDCARD_STATES 8 // Trie nodes which can match a topic at once; each '+' subscription in a topic's path can add one
+#endif
+
+// Topic routers dispatch each document only to the handlers subscribed to its endpoint name, using a trie of names.
+
+namespace Phyllo { namespace Protocol { namespace Application {
+
+// TopicRouter indexes subscriptions in a static-memory trie keyed on endpoint name bytes, so that dispatch costs
+// one walk down the trie along the name instead of a name comparison in every handler.
+// Exact subscriptions receive documents whose name is equal to the subscribed name; prefix subscriptions
+// receive documents whose name starts with the subscribed name. An empty prefix receives every document.
+// Wildcard subscriptions use NameFilter's '+' and '#' wildcards, which are compiled into the same trie: '+' becomes
+// a node which consumes one level of the name, so dispatch still takes a single pass over the name.
+// SingleEndpointHandlers get matching documents through endpointReceived, since the trie has already matched them
+// and their own endpoint's filter may differ from the names they are subscribed to.
+
+template<typename Endpoint, size_t MaxHandlers = 64, size_t MaxNodes = 256, size_t MaxSubscriptions = MaxHandlers>
+class TopicRouter : EndpointHandler<Endpoint> {
+  public:
+    using EndpointHandler = Application::EndpointHandler<Endpoint>;
+    using SingleEndpointHandler = Application::SingleEndpointHandler<Endpoint>;
+    using NodeIndex = uint16_t;
+    using SubscriptionIndex = uint16_t;
+
+    enum class Match : uint8_t {
+      exact = 0,
+      prefix = 1,
+      wildcard = 2
+    };
+
+    static const NodeIndex kNoNode = 0xffff;
+    static const SubscriptionIndex kNoSubscription = 0xffff;
+    static_assert(MaxNodes > 0 && MaxNodes < kNoNode, "Topic router node count must be between 1 and 65534!");
+    static_assert(MaxSubscriptions < kNoSubscription, "Topic router subscription count must be below 65535!");
+    static const size_t kWildcardStates = PHYLLO_APPLICATION_WILDCARD_STATES;
+
+    etl::vector<EndpointHandler *, MaxHandlers> handlers;
+
+    TopicRouter() {
+      nodes.push_back(Node()); // root, for the empty name
+    }
+    template<typename... HandlerTypes>
+    TopicRouter(HandlerTypes&... handlers) : TopicRouter() {
+      using expand_type = int[];
+      expand_type { (addHandler(handlers), 0)... };
+    }
+
+    // Event loop interface
+
+    void setup() {
+      for (auto &handler : handlers) handler->setup();
+    }
+    void update() {
+      for (auto &handler : handlers) handler->update();
+    }
+
+    // Endpoint handler interface
+
+    void receive(const typename Endpoint::ToReceive &document) {
+      // Prefix and multi-level wildcard subscriptions are dispatched as their nodes are reached, then exact subscriptions
+      ByteBufferView name = Endpoint::documentName(document);
+      States states;
+      dispatch(nodes[0].prefix, document);
+      enterLevel(states, 0, document);
+      for (size_t i = 0; i < name.size(); ++i) {
+        States next;
+        for (NodeIndex node : states) {
+          if (nodes[node].level && name[i] != NameFilter::kLevelSeparator) { // '+' consumes the rest of the level
+            addState(next, node);
+            continue;
+          }
+
+          NodeIndex matched = child(node, name[i]);
+          if (matched == kNoNode) continue;
+
+          dispatch(nodes[matched].prefix, document);
+          if (name[i] == NameFilter::kLevelSeparator) enterLevel(next, matched, document);
+          else addState(next, matched);
+        }
+        if (next.empty()) return;
+
+        states = next;
+      }
+      for (NodeIndex node : states) {
+        dispatch(nodes[node].exact, document);
+        NodeIndex separator = child(node, NameFilter::kLevelSeparator);
+        if (separator != kNoNode) dispatch(nodes[separator].multi, document); // "log/#" also matches "log"
+      }
+    }
+    void setToSendDelegate(const typename Endpoint::ToSendDelegate &delegate) {
+      sender = &delegate; // handlers added later also get it
+      for (auto &handler : handlers) handler->setToSendDelegate(delegate);
+    }
+
+    // Router interface
+
+    bool addHandler(SingleEndpointHandler &handler) { // subscribes the handler to its endpoint's name
+      const NameFilter &filter = handler.filter();
+      return subscribe(handler, filter.filter, filter.wildcard ? Match::wildcard : Match::exact);
+    }
+
+    bool addHandler(EndpointHandler &handler) { // subscribes the handler to every name, as Router does
+      return subscribe(handler, ByteBufferView(), Match::prefix);
+    }
+
+    bool subscribe(EndpointHandler &handler, const ByteBufferView &name, Match match = Match::exact) {
+      // A handler can be subscribed to several names; it receives a document once per matching subscription
+      return subscribe(handler, nullptr, name, match);
+    }
+    bool subscribe(EndpointHandler &handler, const char *name, Match match = Match::exact) {
+      return subscribe(handler, ByteBufferView(reinterpret_cast<const uint8_t *>(name), strlen(name)), match);
+    }
+    bool subscribe(SingleEndpointHandler &handler, const ByteBufferView &name, Match match = Match::exact) {
+      return subscribe(handler, &handler, name, match);
+    }
+    bool subscribe(SingleEndpointHandler &handler, const char *name, Match match = Match::exact) {
+      return subscribe(handler, ByteBufferView(reinterpret_cast<const uint8_t *>(name), strlen(name)), match);
+    }
+
+    size_t nodeCount() const { // trie nodes in use, for sizing MaxNodes
+      return nodes.size();
+    }
+
+    unsigned long overflowCount() const { // documents which may have missed subscriptions because too many nodes matched at once
+      return overflows;
+    }
+
+  protected:
+    struct Node {
+      uint8_t key = 0;
+      NodeIndex child = kNoNode; // first child
+      NodeIndex sibling = kNoNode; // next child of the same parent
+      NodeIndex wildcard = kNoNode; // '+' child, which matches any one level
+      SubscriptionIndex exact = kNoSubscription; // first exact subscription
+      SubscriptionIndex prefix = kNoSubscription; // first prefix subscription
+      SubscriptionIndex multi = kNoSubscription; // first subscription with a '#' after this node
+      bool level = false; // whether this node is a '+' wildcard
+    };
+
+    struct Subscription {
+      EndpointHandler *handler;
+      SingleEndpointHandler *single; // the same handler, if documents go straight to its endpointReceived
+      SubscriptionIndex next; // next subscription on the same node
+    };
+
+    etl::vector<Node, MaxNodes> nodes;
+    etl::vector<Subscription, MaxSubscriptions> subscriptions;
+    const typename Endpoint::ToSendDelegate *sender = nullptr;
+    unsigned long overflows = 0;
+
+    using States = etl::vector<NodeIndex, kWildcardStates>;
+
+    bool subscribe(EndpointHandler &handler, SingleEndpointHandler *single, const ByteBufferView &name, Match match) {
+      if (subscriptions.full()) return false;
+      if (!registered(handler) && handlers.full()) return false;
+
+      bool multiLevel = false;
+      NodeIndex node = insert(name, match == Match::wildcard, multiLevel);
+      if (node == kNoNode) return false;
+
+      if (!registered(handler)) {
+        handlers.push_back(&handler);
+        if (sender != nullptr) handler.setToSendDelegate(*sender);
+      }
+      subscriptions.push_back(Subscription{&handler, single, kNoSubscription});
+      SubscriptionIndex subscription = static_cast<SubscriptionIndex>(subscriptions.size() - 1);
+      if (multiLevel) append(nodes[node].multi, subscription);
+      else if (match == Match::prefix) append(nodes[node].prefix, subscription);
+      else append(nodes[node].exact, subscription);
+      return true;
+    }
+
+    NodeIndex child(NodeIndex parent, uint8_t key) const {
+      for (NodeIndex node = nodes[parent].child; node != kNoNode; node = nodes[node].sibling) {
+        if (nodes[node].key == key) return node;
+      }
+      return kNoNode;
+    }
+
+    NodeIndex edge(NodeIndex node, const ByteBufferView &name, size_t i, bool wildcards) const {
+      if (wildcards && NameFilter::wildcardAt(name, i) == NameFilter::kSingleLevelWildcard) return nodes[node].wildcard;
+
+      return child(node, name[i]);
+    }
+
+    NodeIndex addEdge(NodeIndex node, const ByteBufferView &name, size_t i, bool wildcards) {
+      Node added;
+      NodeIndex index = static_cast<NodeIndex>(nodes.size());
+      if (wildcards && NameFilter::wildcardAt(name, i) == NameFilter::kSingleLevelWildcard) {
+        added.level = true;
+        nodes.push_back(added);
+        nodes[node].wildcard = index;
+        return index;
+      }
+
+      added.key = name[i];
+      added.sibling = nodes[node].child;
+      nodes.push_back(added);
+      nodes[node].child = index;
+      return index;
+    }
+
+    NodeIndex insert(const ByteBufferView &name, bool wildcards, bool &multiLevel) {
+      // Returns the node for the name, adding any missing nodes; fails without changes if the trie would overflow.
+      // A final '#' adds no node, since its subscriptions are kept on the node before it
+      size_t size = name.size();
+      multiLevel = wildcards && size && NameFilter::wildcardAt(name, size - 1) == NameFilter::kMultiLevelWildcard;
+      if (multiLevel) --size;
+
+      NodeIndex node = 0;
+      size_t matched = 0;
+      for (; matched < size; ++matched) {
+        NodeIndex next = edge(node, name, matched, wildcards);
+        if (next == kNoNode) break;
+
+        node = next;
+      }
+      if (size - matched > nodes.available()) return kNoNode;
+
+      for (; matched < size; ++matched) node = addEdge(node, name, matched, wildcards);
+      return node;
+    }
+
+    void addState(States &states, NodeIndex node) {
+      if (states.full()) {
+        ++overflows;
+        return;
+      }
+
+      states.push_back(node);
+    }
+
+    void enterLevel(States &states, NodeIndex node, const typename Endpoint::ToReceive &document) {
+      // Called when the name reaches the start of a level, which a '#' or '+' after this node can match
+      addState(states, node);
+      dispatch(nodes[node].multi, document);
+      if (nodes[node].wildcard != kNoNode) addState(states, nodes[node].wildcard);
+    }
+
+    void append(SubscriptionIndex &head, SubscriptionIndex subscription) {
+      // Subscriptions on the same node are dispatched in the order they were made
+      SubscriptionIndex *next = &head;
+      while (*next != kNoSubscription) next = &subscriptions[*next].next;
+      *next = subscription;
+    }
+
+    void dispatch(SubscriptionIndex subscription, const typename Endpoint::ToReceive &document) {
+      for (; subscription != kNoSubscription; subscription = subscriptions[subscription].next) {
+        const Subscription &subscribed = subscriptions[subscription];
+        if (subscribed.single != nullptr) subscribed.single->endpointReceived(document);
+        else subscribed.handler->receive(document);
+      }
+    }
+
+    bool registered(const EndpointHandler &handler) const {
+      for (auto registeredHandler : handlers) {
+        if (registeredHandler == &handler) return true;
+      }
+      return false;
+    }
+};
+
+} } }
\ No newline at end of file
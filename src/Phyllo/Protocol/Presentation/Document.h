@@ -135,6 +135,48 @@ class Document {
     }
 };
 
+// DocumentView references a serialized document in a buffer owned by something else, such as a received frame,
+// instead of copying it into its own buffer. It is only valid while that buffer is unchanged.
+// Documents can also be viewed in place, so anything which only reads a document can take a DocumentView.
+
+template<SerializationFormatCode Format>
+class DocumentView {
+  public:
+    static const size_t kHeaderSize = DocumentHeader::kSize;
+    static const size_t kFooterSize = 0;
+    static const size_t kOverheadSize = kHeaderSize + kFooterSize;
+
+    using Reader = DocumentReader<Format>;
+
+    DocumentHeader header;
+    mutable Reader reader; // Warning: mutating the reader is not considered to break DocumentView constness!
+
+    DocumentView() :
+      reader(ByteBufferView()) {}
+    DocumentView(const Document<Format> &document) :
+      header(document.header), reader(document.body()), dumpView(document.buffer()) {}
+
+    ByteBufferView body() const {
+      return ByteBufferView(dumpView.begin() + kHeaderSize, dumpView.end() - kFooterSize);
+    }
+
+    ByteBufferView buffer() const {
+      return dumpView;
+    }
+
+    bool read(const ByteBufferView &buffer) { // parse the header, and view the buffer without copying it
+      if (buffer.size() < kOverheadSize) return false; // TODO: handle this as an error signal
+      if (!header.read(buffer)) return false;
+
+      dumpView = buffer;
+      reader = Reader(body());
+      return true;
+    }
+
+  protected:
+    ByteBufferView dumpView;
+};
+
 } } }
 
 namespace Phyllo {
@@ -143,5 +185,9 @@ template<Protocol::Presentation::SerializationFormatCode Format>
 Protocol::DataUnitTypeCode getSchema(const Protocol::Presentation::Document<Format> &document) {
     return document.header.schema;
 }
+template<Protocol::Presentation::SerializationFormatCode Format>
+Protocol::DataUnitTypeCode getSchema(const Protocol::Presentation::DocumentView<Format> &document) {
+    return document.header.schema;
+}
 
 }
\ No newline at end of file
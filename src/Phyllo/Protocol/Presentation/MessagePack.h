@@ -46,7 +46,14 @@ class DocumentReader<MsgPack::kFormat> {
       size_t bufferStartOffset = 0, // absolute offset from start of buffer to when the reader can start reading
       size_t bufferEndOffset = 0 // absolute offset from end of buffer to when the reader must stop reading
     ) :
-      buffer(buffer),
+      owner(&buffer),
+      startOffset(bufferStartOffset), endOffset(bufferEndOffset) {}
+    DocumentReader(
+      const ByteBufferView &buffer, // read in place, so the buffer must outlive any reads
+      size_t bufferStartOffset = 0, // absolute offset from start of buffer to when the reader can start reading
+      size_t bufferEndOffset = 0 // absolute offset from end of buffer to when the reader must stop reading
+    ) :
+      view(buffer),
       startOffset(bufferStartOffset), endOffset(bufferEndOffset) {}
 
     // Core reader methods
@@ -54,7 +61,7 @@ class DocumentReader<MsgPack::kFormat> {
     void start() {
       mpack_reader_init_data(
         &reader,
-        reinterpret_cast<const char *>(buffer.data() + startOffset), bufferSize()
+        reinterpret_cast<const char *>(source().data() + startOffset), bufferSize()
       );
     }
 
@@ -65,11 +72,11 @@ class DocumentReader<MsgPack::kFormat> {
     ByteBufferView bufferRemaining() const {
       const char *remaining = nullptr;
       size_t bytesRemaining = mpack_reader_remaining(const_cast<mpack_reader_t *>(&reader), &remaining);
-      return ByteBufferView(buffer.end() - endOffset - bytesRemaining, buffer.end());
+      return ByteBufferView(source().end() - endOffset - bytesRemaining, source().end());
     }
 
     size_t bufferSize() const {
-      return buffer.size() - startOffset - endOffset;
+      return source().size() - startOffset - endOffset;
     }
 
     void flagError(mpack_error_t error) { mpack_reader_flag_error(&reader, error); }
@@ -548,9 +555,16 @@ class DocumentReader<MsgPack::kFormat> {
     }
 
   protected:
-    const ByteBuffer &buffer;
-    const size_t startOffset;
-    const size_t endOffset;
+    const ByteBuffer *owner = nullptr; // a buffer which may be resized between reads, such as a Document's
+    ByteBufferView view; // used if there is no owner
+    size_t startOffset;
+    size_t endOffset;
+
+    ByteBufferView source() const {
+      if (owner != nullptr) return ByteBufferView(*owner);
+
+      return view;
+    }
 
     mpack_tag_t peekTag() const {
       return mpack_peek_tag(const_cast<mpack_reader_t *>(&reader));
@@ -56,6 +56,18 @@ class ProtocolStack {
 
       return application.receive(getPayload(*transportReceived));
     }
+    template<typename Handler>
+    bool receive(Handler &handler) {
+      // Passes the received document to the handler as a view of the transport's buffer, instead of returning a copy
+      auto transportReceived = transport.receive();
+      if (!transportReceived) return false;
+
+      auto received = application.receiveView(getPayload(*transportReceived));
+      if (!received) return false;
+
+      handler.receive(*received);
+      return true;
+    }
 
     // No send methods because the calling interface can vary; instead, call top.send()!
 };
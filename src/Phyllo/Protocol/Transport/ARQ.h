@@ -3,7 +3,7 @@
 // Standard libraries
 
 // Third-party libraries
-#include <etl/queue.h>
+#include <etl/deque.h>
 #include <etl/delegate.h>
 
 // Phyllo
@@ -12,61 +12,184 @@
 #include "ReliableBuffer.h"
 #include "DatagramLink.h"
 
+#ifndef PHYLLO_TRANSPORT_ARQ_WINDOW_SIZE
+#define PHYLLO_TRANSPORT_ARQ_WINDOW_SIZE 8 // Increase this to keep high-latency links full, at the cost of one ReliableBuffer of RAM per reliableBuffer in flight
+#endif
+
 // WARNING: implementation is incomplete!
 
 namespace Phyllo { namespace Protocol { namespace Transport {
 
 class GBNSender {
   public:
+    using SequenceNumber = ReliableBufferHeader::SequenceNumber;
+
     static const size_t kReceiverWindowSize = 1;  // implicit in algorithm implementation
-    static const size_t kSenderWindowSize = 8;
-    static const size_t kSendQueueSize = 8;
-    static const size_t kSequenceNumberSpace = 256;
+    static const size_t kSenderWindowSize = PHYLLO_TRANSPORT_ARQ_WINDOW_SIZE;
+    static const size_t kUrgentReserve = 1; // send queue slots which only urgent reliableBuffers may use
+    static const size_t kSendQueueSize = kSenderWindowSize + kUrgentReserve;
+    static const size_t kSequenceNumberSpace = ReliableBufferHeader::kSequenceNumberSpace;
+    static const size_t kExtendedSequenceNumberSpace = ReliableBufferHeader::kExtendedSequenceNumberSpace;
     static_assert(
-      kSenderWindowSize <= kSequenceNumberSpace - kReceiverWindowSize,
+      kSenderWindowSize <= kExtendedSequenceNumberSpace - kReceiverWindowSize,
       "Sum of sender window size and receiver window size cannot exceed size of sequence number space"
     );
+    static const unsigned int kRetransmitTimeout = 50; // ms
+
+    GBNSender() : retransmitTimer(kRetransmitTimeout) {}
 
     // Event loop interface
 
     void setup() {}
-    void update() {}
+    void update() {
+      if (!retransmitTimer.timedOut()) return;
+
+      ++losses;
+      goBack(); // no acknowledgement arrived in time, so resend all in-flight reliableBuffers
+    }
 
     // ARQReceiver interface
 
     void receive(const ReliableBuffer &reliableBuffer) {
-      // TODO: check the flags to see whether we need to re-send an in-flight reliableBuffer
+      const ReliableBufferHeader &header = reliableBuffer.header;
+      if (!header.flags.value.ack) return;
+
+      acknowledge(expand(header.ackNum, header.flags.value.ext));
+      if (!header.flags.value.nak) return;
+
+      ++losses;
+      goBack();
     }
-    
+
     // ARQSender interface
 
+    size_t windowSize() const {
+      // Without the extended header, the window must fit in the 8-bit sequence number space
+      if (extended) return kSenderWindowSize;
+
+      static const size_t kBasicWindowSize = kSequenceNumberSpace - kReceiverWindowSize;
+      return (kSenderWindowSize < kBasicWindowSize) ? kSenderWindowSize : kBasicWindowSize;
+    }
+
+    size_t inFlight() const {
+      return nextToSend;
+    }
+
     bool readyToSend() const {
-      return false;
+      return nextToSend < sendQueue.size() && nextToSend < windowSize();
     }
 
     const ReliableBuffer &reliableBufferToSend() const {
-      return sendQueue.front();
+      return sendQueue[nextToSend];
+    }
+
+    SequenceNumber seqNumToSend() const {
+      return static_cast<SequenceNumber>(sendBase + nextToSend);
+    }
+
+    void sent() {
+      ++nextToSend;
+      if (nextToSend > numbered) numbered = nextToSend;
+      if (!retransmitTimer.enabled) retransmitTimer.start();
     }
 
     bool readyToEnqueue() const {
-      return !sendQueue.full();
+      return enqueueAvailable() > 0;
+    }
+
+    size_t enqueueAvailable() const {
+      size_t available = sendQueue.available();
+      if (available <= kUrgentReserve) return 0;
+
+      return available - kUrgentReserve;
     }
 
     bool enqueue(const ReliableBuffer &reliableBuffer) {
+      if (!enqueueAvailable()) return false;
+      sendQueue.push_back(reliableBuffer);
+      return true;
+    }
+
+    bool enqueueUrgent(const ReliableBuffer &reliableBuffer) {
+      // Sequence numbers are only assigned on sending, so an urgent reliableBuffer can go ahead of everything
+      // which was never sent; it stays behind earlier unsent urgent reliableBuffers, which share its type
       if (sendQueue.full()) return false;
-      sendQueue.push(reliableBuffer);
+
+      size_t position = numbered;
+      while (position < sendQueue.size() && sendQueue[position].header.type == reliableBuffer.header.type) ++position;
+      sendQueue.insert(sendQueue.begin() + position, reliableBuffer);
       return true;
     }
 
+    void setExtended(bool extended) {
+      this->extended = extended;
+    }
+
+    unsigned long lossCount() const { // number of NAKs and retransmission timeouts so far
+      return losses;
+    }
+
+    // Session interface
+
+    SequenceNumber base() const {
+      return sendBase;
+    }
+
+    void resend() {
+      // Queued reliableBuffers are kept and renumbered from sendBase, so they survive a resynchronization
+      numbered = 0;
+      goBack();
+    }
+
+    void reset() {
+      sendQueue.clear();
+      sendBase = 0;
+      numbered = 0;
+      goBack();
+    }
+
   protected:
-    ReliableBufferHeader::SequenceNumber seqNumMin = 0;
-    ReliableBufferHeader::SequenceNumber seqNumMax = 0;
+    SequenceNumber sendBase = 0; // sequence number of the oldest unacknowledged reliableBuffer
+    size_t nextToSend = 0; // index in sendQueue of the next reliableBuffer to send; all reliableBuffers before it are in flight
+    size_t numbered = 0; // number of reliableBuffers in sendQueue which were sent, and so keep their sequence numbers on a go-back
+    bool extended = false;
+    unsigned long losses = 0;
+    Util::TimeoutTimer retransmitTimer;
+
+    etl::deque<ReliableBuffer, kSendQueueSize> sendQueue;
+
+    SequenceNumber expand(SequenceNumber ackNum, bool extendedHeader) const {
+      // Recover the full acknowledgement number from the low byte carried by a basic header
+      if (extendedHeader) return ackNum;
+
+      return static_cast<SequenceNumber>(
+        sendBase + static_cast<ReliableBufferHeader::SequenceNumberByte>(ackNum - sendBase)
+      );
+    }
+
+    void acknowledge(SequenceNumber ackNum) {
+      // Acknowledgements are cumulative, so every in-flight reliableBuffer before ackNum was received
+      size_t acknowledged = static_cast<SequenceNumber>(ackNum - sendBase);
+      if (acknowledged == 0 || acknowledged > nextToSend) return; // duplicate or out-of-window acknowledgement
 
-    etl::queue<ReliableBuffer, kSendQueueSize, etl::memory_model::MEMORY_MODEL_SMALL> sendQueue;
+      for (size_t i = 0; i < acknowledged; ++i) sendQueue.pop_front();
+      sendBase = ackNum;
+      nextToSend -= acknowledged;
+      numbered -= acknowledged;
+      if (nextToSend) retransmitTimer.start();
+      else retransmitTimer.resetAndStop();
+    }
+
+    void goBack() {
+      nextToSend = 0;
+      retransmitTimer.resetAndStop();
+    }
 };
 
 class GBNReceiver {
   public:
+    using SequenceNumber = ReliableBufferHeader::SequenceNumber;
+
     static const size_t kReceiverWindowSize = 1;  // implicit in algorithm implementation
     static const unsigned int kPiggybackTimeout = 4; // ms
 
@@ -91,7 +214,10 @@ class GBNReceiver {
     // GBNReceiver interface
 
     bool receive(const ReliableBuffer &reliableBuffer) {
-      bool reliableBufferReceived = (reliableBuffer.header.seqNum == nextExpected); // TODO: use the nos field
+      const ReliableBufferHeader &header = reliableBuffer.header;
+      if (header.flags.value.nos) return true; // reliableBuffers sent in unreliable transmission mode bypass the receiver window
+
+      bool reliableBufferReceived = expected(header);
       //reliableBufferReceived = true; // debugging test
       //if (reliableBuffer.header.seqNum > 2 && !sentNAK) reliableBufferReceived = false; // debugging test
       if (reliableBufferReceived) {
@@ -110,6 +236,7 @@ class GBNReceiver {
       reliableBufferHeader.ackNum = nextExpected;
       reliableBufferHeader.flags.value.ack = true;
       reliableBufferHeader.flags.value.nak = sendNAK && !sentNAK;
+      reliableBufferHeader.flags.value.ext = extended;
     }
 
     void sent(const ReliableBufferHeader &reliableBufferHeader) {
@@ -117,16 +244,39 @@ class GBNReceiver {
       if (reliableBufferHeader.flags.value.nak) sentNAK = true;
     }
 
+    void setExtended(bool extended) {
+      this->extended = extended;
+    }
+
+    // Session interface
+
+    void synchronize(SequenceNumber nextExpected) {
+      this->nextExpected = nextExpected;
+      sendNAK = false;
+      sentNAK = false;
+    }
+
   protected:
     // Acknowledgements
-    ReliableBufferHeader::SequenceNumber nextExpected = 0;
+    SequenceNumber nextExpected = 0;
     bool sendNAK = false;
     bool sentNAK = false;
+    bool extended = false;
     Util::TimeoutTask piggybackSender;
     bool &issueRequest = piggybackSender.timer.enabled;
 
     const ToSendDelegate &sender;
 
+    bool expected(const ReliableBufferHeader &header) const {
+      // A basic header only carries the low byte of the sequence number
+      if (header.flags.value.ext) return header.seqNum == nextExpected;
+
+      return (
+        static_cast<ReliableBufferHeader::SequenceNumberByte>(header.seqNum)
+        == static_cast<ReliableBufferHeader::SequenceNumberByte>(nextExpected)
+      );
+    }
+
     void sendRequest() { // TODO: actually, should we just expose readyToSend and reliableBufferToSend for reliableBufferLink to send? We do want to bypass arqSender's queue by sending it as an unreliable reliableBuffer
       ReliableBuffer reliableBuffer;
       prepare(reliableBuffer.header);
@@ -0,0 +1,214 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libraries
+#include <etl/delegate.h>
+#include <etl/queue.h>
+
+// Phyllo
+#include "Phyllo/Types.h"
+#include "Phyllo/Util/Timing.h"
+#include "Phyllo/Util/Struct.h"
+#include "Phyllo/Protocol/Types.h"
+#include "ReliableBuffer.h"
+
+#ifndef PHYLLO_TRANSPORT_STREAM_COALESCE_DELAY
+#define PHYLLO_TRANSPORT_STREAM_COALESCE_DELAY 5 // ms to hold a partial segment for more writes before sending it; 0 sends every write immediately
+#endif
+
+#ifndef PHYLLO_TRANSPORT_STREAM_RECEIVE_SIZE
+#define PHYLLO_TRANSPORT_STREAM_RECEIVE_SIZE 256 // bytes of received stream data held until the application reads them; must hold a full segment
+#endif
+
+// Byte Stream layer carries a byte stream as segments, coalescing small writes so that each segment fills a frame.
+// Over StandardLogicalStack the segments are sent as reliableBuffers, so the stream is reliable and ordered.
+// Each segment carries the stream offset of its first byte, and the receiver advertises the offset up to which it has
+// room for more bytes, so the sender never sends what the receiver would have to drop after the ARQ acknowledged it.
+
+namespace Phyllo { namespace Protocol { namespace Transport {
+
+class ByteStreamLink {
+  public:
+    using Offset = uint16_t;
+    using OffsetField = Util::StructField<Offset, 0>; // 2 bytes; stream offset of the first byte of a segment, or window edge
+
+    static const DataUnitTypeCode kType = DataUnitType::Bytes::Stream;
+    static const DataUnitTypeCode kWindowType = 0x0b; // layer-defined type for receive window advertisements
+    static const size_t kHeaderSize = OffsetField::kSize;
+    static const size_t kSegmentSize = ReliableBuffer::kPayloadSizeLimit - kHeaderSize; // stream bytes per segment
+    static const size_t kReceiveSize = PHYLLO_TRANSPORT_STREAM_RECEIVE_SIZE;
+    static const unsigned long kCoalesceDelay = PHYLLO_TRANSPORT_STREAM_COALESCE_DELAY;
+    static const unsigned long kProbeInterval = 200; // ms between empty segments asking for the window while it is closed
+    static_assert(kReceiveSize >= kSegmentSize, "Stream receive size must hold a full segment!");
+    static_assert(kReceiveSize < 0x8000, "Stream receive size must fit in half of the offset space!");
+
+    using ToReceive = ByteBufferView; // The type of data passed up from below
+    using Receive = uint8_t; // The type of data passed up to above
+    using Send = ByteBufferView; // The type of data passed down from above
+    using ToSend = ByteBufferView; // The type of data passed down to below
+    using ToSendDelegate = etl::delegate<bool(const ToSend &, DataUnitTypeCode)>;
+
+    ByteStreamLink(const ToSendDelegate &delegate) :
+      sender(delegate), coalesceTimer(kCoalesceDelay), probeTimer(kProbeInterval) {}
+    ByteStreamLink(const ByteStreamLink &link) = delete; // prevent accidental copy-by-value
+
+    // Event loop interface
+
+    void setup() {}
+
+    void update() {
+      if (segment.full() || coalesceTimer.timedOut()) flush(); // retry until the lower layers accept the segment
+      if (probeTimer.timedOut()) probe(); // in case a window advertisement was lost
+      if (Offset(windowEdge() - advertisedEdge) >= kReceiveSize / 2) advertise(); // reads have freed up enough room
+    }
+
+    // ByteBufferLink interface
+
+    bool receive(const ByteBufferView &buffer, DataUnitTypeCode type) {
+      // Returns whether the buffer was a stream segment or window, so that other traffic can be passed along
+      if (type == kWindowType) {
+        if (buffer.size() >= kHeaderSize) receiveWindow(OffsetField::parse(buffer));
+        return true;
+      }
+      if (type != kType) return false;
+      if (buffer.size() < kHeaderSize) return true;
+
+      receiveOffset = OffsetField::parse(buffer); // skips any bytes lost below an unreliable logical stack
+      if (buffer.size() == kHeaderSize) { // the sender is probing a closed window
+        advertise();
+        return true;
+      }
+      for (size_t i = kHeaderSize; i < buffer.size(); ++i) {
+        ++receiveOffset;
+        if (received.full()) ++discardedBytes; // only if the peer ignored our window
+        else received.push(buffer[i]);
+      }
+      return true;
+    }
+
+    size_t send(const ByteBufferView &buffer) {
+      // Returns the number of bytes accepted, which is less than requested when segments can't be sent yet
+      size_t written = 0;
+      while (written < buffer.size()) {
+        if (segment.full() && !flush()) break; // backpressure from the lower layers
+
+        size_t length = buffer.size() - written;
+        if (length > segment.available()) length = segment.available();
+        size_t size = segment.size();
+        segment.resize(size + length);
+        memcpy(segment.data() + size, buffer.data() + written, length);
+        written += length;
+      }
+      if (segment.full()) flush(); // a full segment gains nothing from waiting
+      else if (!segment.empty() && !coalesceTimer.enabled) coalesceTimer.start();
+      return written;
+    }
+
+    // Read interface
+
+    int available() const {
+      return received.size();
+    }
+
+    int peek() const {
+      if (received.empty()) return -1;
+
+      return received.front();
+    }
+
+    int read() {
+      if (received.empty()) return -1;
+
+      uint8_t byte = received.front();
+      received.pop();
+      return byte;
+    }
+
+    // Write interface
+
+    size_t availableForWrite() const {
+      return segment.available();
+    }
+
+    bool flush() { // send as much of any partial segment as the peer's receive window allows now
+      if (segment.empty()) return true;
+
+      size_t size = segment.size();
+      if (size > windowAvailable()) size = windowAvailable();
+      if (!size) { // wait for the peer's application to read
+        if (!probeTimer.enabled) probeTimer.start();
+        return false;
+      }
+
+      FixedByteBuffer<ReliableBuffer::kPayloadSizeLimit> toSend;
+      toSend.resize(kHeaderSize + size);
+      OffsetField(sendOffset).write(toSend);
+      memcpy(toSend.data() + kHeaderSize, segment.data(), size);
+      if (!sender(ByteBufferView(toSend), kType)) return false; // e.g. the send window is full, so try again later
+
+      sendOffset += size;
+      memmove(segment.data(), segment.data() + size, segment.size() - size);
+      segment.resize(segment.size() - size);
+      if (!segment.empty()) { // the rest waits for the peer's window to open
+        if (!coalesceTimer.enabled) coalesceTimer.start();
+        return false;
+      }
+
+      coalesceTimer.resetAndStop();
+      return true;
+    }
+
+    size_t windowAvailable() const { // bytes which the peer has room to receive
+      Offset window = peerEdge - sendOffset;
+      return (window < 0x8000) ? window : 0;
+    }
+
+    unsigned long discardedByteCount() const { // received bytes dropped because the peer ignored our receive window
+      return discardedBytes;
+    }
+
+  protected:
+    const ToSendDelegate &sender;
+
+    FixedByteBuffer<kSegmentSize> segment;
+    Util::TimeoutTimer coalesceTimer;
+    Util::TimeoutTimer probeTimer;
+    Offset sendOffset = 0;
+    Offset peerEdge = kSegmentSize; // every peer has room for a full segment before it has advertised its window
+
+    etl::queue<uint8_t, kReceiveSize> received;
+    Offset receiveOffset = 0;
+    Offset advertisedEdge = kSegmentSize;
+    unsigned long discardedBytes = 0;
+
+    Offset windowEdge() const {
+      return receiveOffset + (kReceiveSize - received.size());
+    }
+
+    void advertise() {
+      FixedByteBuffer<kHeaderSize> window;
+      window.resize(kHeaderSize);
+      Offset edge = windowEdge();
+      OffsetField(edge).write(window);
+      if (sender(ByteBufferView(window), kWindowType)) advertisedEdge = edge; // otherwise update() will try again
+    }
+
+    void receiveWindow(Offset edge) {
+      if (Offset(edge - peerEdge) >= 0x8000) return; // stale, e.g. reordered below an unreliable logical stack
+
+      peerEdge = edge;
+      if (windowAvailable()) probeTimer.resetAndStop();
+    }
+
+    void probe() {
+      FixedByteBuffer<kHeaderSize> empty;
+      empty.resize(kHeaderSize);
+      OffsetField(sendOffset).write(empty);
+      sender(ByteBufferView(empty), kType);
+      if (windowAvailable()) probeTimer.resetAndStop();
+      else probeTimer.start();
+    }
+};
+
+} } }
\ No newline at end of file
@@ -0,0 +1,238 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libraries
+
+// Phyllo
+#include "Phyllo/Types.h"
+#include "Phyllo/Util/Struct.h"
+#include "Phyllo/Util/Timing.h"
+#include "Phyllo/Protocol/Types.h"
+#include "Phyllo/Protocol/Presentation/Types.h"
+#include "ChunkedStreamLink.h"
+#include "FrameLink.h"
+#include "Datagram.h"
+#include "DatagramLink.h"
+#include "ReliableBuffer.h"
+#include "ARQ.h"
+
+#ifndef PHYLLO_TRANSPORT_CAPABILITIES_ADVERTISE
+#define PHYLLO_TRANSPORT_CAPABILITIES_ADVERTISE 0 // Advertise capabilities at setup; otherwise only reply to peers which advertise theirs
+#endif
+
+// Capabilities are exchanged between peers at setup so that each link can use the best settings both peers support.
+// Peers built without the exchange pass its datagrams up as unknown payloads, so advertising is opt-in.
+
+namespace Phyllo { namespace Protocol { namespace Transport {
+
+class CapabilityFlags {
+  public:
+    using Bitfield = uint8_t;
+
+    template<size_t Position>
+    using Flag = Util::BitfieldFlag<Bitfield, Position>;
+
+    Flag<0> known; // the sender has already received the receiver's capabilities, so no reply is needed
+    Flag<1> ext; // the sender supports the extended reliableBuffer header
+
+    CapabilityFlags() {} // default constructor leaves all flags false
+    CapabilityFlags(Bitfield bitfield) : // implicit conversion from Bitfield
+      known(bitfield),
+      ext(bitfield) {}
+
+    operator Bitfield() const { // implicit conversion to Bitfield
+      return (
+        Bitfield(0)
+        | known.bitfield()
+        | ext.bitfield()
+      );
+    }
+};
+
+class Capabilities {
+  public:
+    using ChunkSize = uint16_t;
+    using WindowSize = uint16_t;
+
+    using FlagsField = Util::StructField<CapabilityFlags, 0, CapabilityFlags::Bitfield>; // 1 byte
+    using CRCField = Util::StructField<uint8_t, FlagsField::kAfterOffset>; // 1 byte; CRC variant used by validated datagrams
+    using FormatField = Util::StructField<Presentation::SerializationFormatCode, CRCField::kAfterOffset>; // 1 byte; preferred document serialization format
+    using ChunkSizeField = Util::StructField<ChunkSize, FormatField::kAfterOffset>; // 2 bytes; largest chunk which can be received
+    using WindowSizeField = Util::StructField<WindowSize, ChunkSizeField::kAfterOffset>; // 2 bytes; ARQ sender window size
+
+    static const size_t kSize = (
+      0
+      + FlagsField::kSize
+      + CRCField::kSize
+      + FormatField::kSize
+      + ChunkSizeField::kSize
+      + WindowSizeField::kSize
+    );
+
+    static const uint8_t kCRCRay32sub8 = 0x01; // Util::kCRCPolynomial
+
+    FlagsField flags;
+    CRCField crc = kCRCRay32sub8;
+    FormatField format = Presentation::SerializationFormat::Binary::Dynamic::MsgPack;
+    ChunkSizeField chunkSizeLimit = ChunkedStreamLink::kSizeLimit;
+    WindowSizeField windowSize = GBNSender::kSenderWindowSize;
+
+    Capabilities() {
+      flags.value.ext = ReliableBuffer::kExtendedHeaderSupported;
+    }
+
+    bool read(const ByteBufferView &buffer) {
+      if (buffer.size() < kSize) return false; // fields appended by later protocol versions are ignored
+
+      flags.read(buffer);
+      crc.read(buffer);
+      format.read(buffer);
+      chunkSizeLimit.read(buffer);
+      windowSize.read(buffer);
+      return true;
+    }
+
+    bool write(ByteBuffer &buffer) const {
+      if (buffer.size() < kSize) return false;
+
+      flags.write(buffer);
+      crc.write(buffer);
+      format.write(buffer);
+      chunkSizeLimit.write(buffer);
+      windowSize.write(buffer);
+      return true;
+    }
+
+    Capabilities common(const Capabilities &peer) const {
+      // The best settings which both peers support
+      Capabilities common;
+      common.flags.value.ext = flags.value.ext && peer.flags.value.ext;
+      common.crc = (crc == peer.crc) ? crc.value : 0;
+      common.format = (format == peer.format) ? format.value : Presentation::SerializationFormat::Binary::Dynamic::Unknown;
+      common.chunkSizeLimit = (chunkSizeLimit < peer.chunkSizeLimit) ? chunkSizeLimit.value : peer.chunkSizeLimit.value;
+      common.windowSize = (windowSize < peer.windowSize) ? windowSize.value : peer.windowSize.value;
+      return common;
+    }
+
+    size_t datagramPayloadSizeLimit(size_t linkOverhead = 0) const {
+      // The largest datagram payload which fits in a chunk of chunkSizeLimit, where linkOverhead is added to each
+      // frame payload between datagrams and frames, e.g. FEC parity bytes
+      const size_t overhead = (
+        ChunkedStreamLink::kOverheadSize + FrameLink::kOverheadSize + linkOverhead + Datagram::kOverheadSize
+      );
+      if (chunkSizeLimit <= overhead || Datagram::kPayloadSizeLimit <= linkOverhead) return 0;
+
+      size_t limit = chunkSizeLimit - overhead;
+      if (limit > Datagram::kPayloadSizeLimit - linkOverhead) limit = Datagram::kPayloadSizeLimit - linkOverhead;
+      return limit;
+    }
+};
+
+class CapabilitiesExchange {
+  public:
+    static const uint8_t kProtocolVersion = 1;
+    static const bool kAdvertise = PHYLLO_TRANSPORT_CAPABILITIES_ADVERTISE;
+    static const unsigned long kRetryInterval = 500; // ms between advertisements until the peer has received ours
+    static const uint8_t kRetryLimit = 8; // unanswered advertisements before giving up, e.g. because the peer lacks the exchange
+
+    CapabilitiesExchange(DatagramLink &datagram) :
+      datagram(datagram), retryTimer(kRetryInterval) {}
+
+    // Event loop interface
+
+    void setup() {
+      if (kAdvertise) start();
+    }
+
+    void update() {
+      if (retryTimer.timedOut()) advertise();
+    }
+
+    // CapabilitiesExchange interface
+
+    void start() { // advertise until the peer replies or kRetryLimit advertisements go unanswered
+      unanswered = 0;
+      advertise();
+    }
+
+    bool receive(const Datagram &received) {
+      // Returns whether the datagram was consumed by the exchange
+      ByteBufferView payload = received.payload();
+      switch (received.header.type) {
+        case DataUnitType::Layer::Version:
+          if (payload.size() >= 1) peerVersion = payload[0];
+          return true;
+        case DataUnitType::Layer::Capabilities:
+          receiveCapabilities(payload);
+          return true;
+        default:
+          return false;
+      }
+    }
+
+    bool negotiated() const {
+      return peerReceived;
+    }
+
+    bool compatible() const { // a mismatch here would make validated datagrams fail silently, so check it
+      return peerReceived && peerVersion == kProtocolVersion && localCapabilities.crc == peerCapabilities.crc;
+    }
+
+    const Capabilities &local() const {
+      return localCapabilities;
+    }
+
+    const Capabilities &peer() const {
+      return peerCapabilities;
+    }
+
+    Capabilities common() const {
+      if (!peerReceived) return localCapabilities;
+
+      return localCapabilities.common(peerCapabilities);
+    }
+
+    void setLinkOverhead(size_t overhead) { // bytes added to each frame payload below the datagram link, e.g. by FECLink
+      linkOverhead = overhead;
+      datagram.setPayloadSizeLimit(common().datagramPayloadSizeLimit(linkOverhead));
+    }
+
+  protected:
+    DatagramLink &datagram;
+    Util::TimeoutTimer retryTimer;
+
+    Capabilities localCapabilities;
+    Capabilities peerCapabilities;
+    uint8_t peerVersion = 0;
+    bool peerReceived = false;
+    uint8_t unanswered = 0;
+    size_t linkOverhead = 0;
+
+    void advertise() {
+      const uint8_t version[] = {kProtocolVersion};
+      datagram.send(ByteBufferView(version, sizeof(version)), DataUnitType::Layer::Version);
+
+      Capabilities advertised = localCapabilities;
+      advertised.flags.value.known = peerReceived;
+      FixedByteBuffer<Capabilities::kSize> buffer;
+      buffer.resize(Capabilities::kSize);
+      advertised.write(buffer);
+      datagram.send(ByteBufferView(buffer), DataUnitType::Layer::Capabilities);
+      if (peerReceived || ++unanswered >= kRetryLimit) retryTimer.resetAndStop(); // if a reply is lost, the peer will advertise again
+      else retryTimer.start();
+    }
+
+    void receiveCapabilities(const ByteBufferView &payload) {
+      Capabilities received;
+      if (!received.read(payload)) return;
+
+      peerCapabilities = received;
+      peerReceived = true;
+      datagram.setPayloadSizeLimit(common().datagramPayloadSizeLimit(linkOverhead)); // so oversized sends fail locally instead of being dropped by the peer
+      if (!received.flags.value.known) advertise(); // reply, e.g. because the peer was just reset
+      else retryTimer.resetAndStop(); // the peer has ours
+    }
+};
+
+} } }
\ No newline at end of file
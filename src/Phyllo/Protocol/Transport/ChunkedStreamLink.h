@@ -4,7 +4,6 @@
 
 // Third-party libraries
 #include <etl/algorithm.h>
-#include <etl/array.h>
 #include <etl/delegate.h>
 #include <PacketSerial.h>
 
@@ -16,10 +15,6 @@
 
 // Chunked Stream layer handles data framing
 
-#ifndef PHYLLO_TRANSPORT_CHUNK_SIZE_LIMIT
-#define PHYLLO_TRANSPORT_CHUNK_SIZE_LIMIT 255  // For USB, 255 ensures that the starting delimiter won't be translated as its own USB packet, for higher performance on max-length chunks
-#endif
-
 namespace Phyllo { namespace Protocol { namespace Transport {
 
 class ChunkedStreamLink {
@@ -39,9 +34,7 @@ class ChunkedStreamLink {
     using ToSend = ByteBufferView;
     using ToSendDelegate = etl::delegate<bool(const ToSend &, DataUnitTypeCode)>;
 
-    ChunkedStreamLink(const ToSendDelegate &delegate) : 
-      sender(delegate),
-      kChunkMarkerBufferView(kChunkMarkerBuffer.begin(), kChunkMarkerBuffer.end()) {}
+    ChunkedStreamLink(const ToSendDelegate &delegate) : sender(delegate) {}
     ChunkedStreamLink(const ChunkedStreamLink &chunkLink) = delete; // prevent accidental copy-by-value
 
     // Peek interface
@@ -57,7 +50,6 @@ class ChunkedStreamLink {
 
     void consume() {
       receivedChunk = false;
-      receivedBufferOverflowed = false;
       receivedBuffer.clear();
     }
 
@@ -78,46 +70,91 @@ class ChunkedStreamLink {
       } else {
         receiveGenericByte(streamByte);
       }
-      return OptionalReceive();
+      return received;
+    }
+
+    size_t receive(const ByteBufferView &streamBytes) {
+      // Receives bytes up to and including the next chunk marker, and returns the number of bytes consumed.
+      // As with single bytes, the consume method must be called after a chunk is received.
+      const uint8_t *marker = static_cast<const uint8_t *>(
+        memchr(streamBytes.data(), kChunkMarker, streamBytes.size())
+      );
+      size_t length = marker ? marker - streamBytes.data() : streamBytes.size();
+      receiveGenericBytes(ByteBufferView(streamBytes.data(), length));
+      if (!marker) return length;
+
+      receiveChunkMarker();
+      return length + 1;
     }
 
-    bool overflowReceived() const {
+    bool overflowReceived() const { // whether bytes are being skipped until the next chunk marker
       return receivedBufferOverflowed;
     }
 
+    // Error counters
+
+    unsigned long overflowCount() const { // overlong chunks which were discarded
+      return overflowedChunks;
+    }
+
+    unsigned long discardedByteCount() const { // bytes skipped while resynchronizing to the next chunk marker
+      return discardedBytes;
+    }
+
     bool send(const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Transport::Frame) {
       if (payload.empty()) return false;
       if (payload.size() > kPayloadSizeLimit) return false;
 
-      sendChunkMarker();
-      bool sendStatus = sender(payload, DataUnitType::Bytes::Stream);
-      sendChunkMarker();
-      return sendStatus;
+      // Send the chunk as one buffer, so that the stream either takes all of it or none of it
+      FixedChunkFrame chunkFrame;
+      chunkFrame.resize(payload.size() + 2);
+      chunkFrame[0] = kChunkMarker;
+      memcpy(chunkFrame.data() + 1, payload.data(), payload.size());
+      chunkFrame[payload.size() + 1] = kChunkMarker;
+      return sender(ByteBufferView(chunkFrame), DataUnitType::Bytes::Stream);
     }
 
   protected:
     using FixedChunk = FixedByteBuffer<kSizeLimit>;
+    using FixedChunkFrame = FixedByteBuffer<kPayloadSizeLimit + 2>; // with the starting and ending chunk markers
 
     const ToSendDelegate &sender;
 
-    const etl::array<uint8_t, 1> kChunkMarkerBuffer = {{ kChunkMarker }};
-    const ByteBufferView kChunkMarkerBufferView;
-
     FixedChunk receivedBuffer;
     bool receivedBufferOverflowed = false;
     bool receivedChunk = false;
+    unsigned long overflowedChunks = 0;
+    unsigned long discardedBytes = 0;
 
     void receiveChunkMarker() {
+      if (receivedBufferOverflowed) { // never pass a truncated chunk up for decoding
+        ++overflowedChunks;
+        receivedBufferOverflowed = false;
+        receivedBuffer.clear();
+      }
       receivedChunk = !receivedBuffer.empty();
     }
 
     void receiveGenericByte(uint8_t receivedByte) {
-      receivedBufferOverflowed = receivedBuffer.full();
-      if (!receivedBufferOverflowed) receivedBuffer.push_back(receivedByte);
+      receiveGenericBytes(ByteBufferView(&receivedByte, 1));
     }
 
-    void sendChunkMarker() {
-      sender(kChunkMarkerBufferView, DataUnitType::Bytes::Stream);
+    void receiveGenericBytes(const ByteBufferView &receivedBytes) {
+      if (receivedBytes.empty()) return;
+      if (!receivedBufferOverflowed && receivedBytes.size() > receivedBuffer.available()) {
+        // The chunk is overlong, so skip everything until the next chunk marker
+        discardedBytes += receivedBuffer.size();
+        receivedBuffer.clear();
+        receivedBufferOverflowed = true;
+      }
+      if (receivedBufferOverflowed) {
+        discardedBytes += receivedBytes.size();
+        return;
+      }
+
+      size_t size = receivedBuffer.size();
+      receivedBuffer.resize(size + receivedBytes.size());
+      memcpy(receivedBuffer.data() + size, receivedBytes.data(), receivedBytes.size());
     }
 };
 
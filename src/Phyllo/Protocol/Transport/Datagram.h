@@ -201,7 +201,7 @@ class ValidatedDatagram {
     static const size_t kHeaderSize = ValidatedDatagramHeader::kSize;
     static const size_t kFooterSize = 0;
     static const size_t kOverheadSize = kHeaderSize + kFooterSize;
-    static const size_t kPayloadSizeLimit = FrameLink::kPayloadSizeLimit - kOverheadSize;
+    static const size_t kPayloadSizeLimit = Datagram::kPayloadSizeLimit - kOverheadSize; // validatedDatagrams are carried in datagrams
 
     ValidatedDatagramHeader header;
 
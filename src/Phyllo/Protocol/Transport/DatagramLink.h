@@ -45,7 +45,7 @@ class DatagramLink {
     }
 
     bool send(const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Bytes::Buffer) {
-      if (payload.size() > Datagram::kPayloadSizeLimit) return false;
+      if (payload.size() > payloadSizeLimit) return false;
 
       Datagram datagram;
       datagram.header.type = type;
@@ -58,9 +58,16 @@ class DatagramLink {
       datagram.writeHeader();
       return sender(datagram.buffer(), Datagram::kType); // TODO: handle error
     }
+
+    void setPayloadSizeLimit(size_t limit) { // e.g. the largest payload the peer can receive, from capability negotiation
+      if (limit > Datagram::kPayloadSizeLimit) limit = Datagram::kPayloadSizeLimit;
+      payloadSizeLimit = limit;
+    }
   
   protected:
     const ToSendDelegate &sender;
+
+    size_t payloadSizeLimit = Datagram::kPayloadSizeLimit;
 };
 
 class ValidatedDatagramLink {
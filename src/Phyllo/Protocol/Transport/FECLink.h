@@ -0,0 +1,98 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libraries
+#include <etl/delegate.h>
+
+// Phyllo
+#include "Phyllo/Types.h"
+#include "Phyllo/Util/Optional.h"
+#include "Phyllo/Util/ReedSolomon.h"
+#include "Phyllo/Protocol/Types.h"
+#include "FrameLink.h"
+
+// FEC layer corrects small bursts of corrupted bytes in frame payloads without retransmission round trips
+
+#ifndef PHYLLO_TRANSPORT_FEC_PARITY_SIZE
+#define PHYLLO_TRANSPORT_FEC_PARITY_SIZE 8 // Each pair of parity bytes allows correction of one corrupted byte per frame
+#endif
+
+namespace Phyllo { namespace Protocol { namespace Transport {
+
+class FECLink {
+  public:
+    using Code = Util::ReedSolomon<PHYLLO_TRANSPORT_FEC_PARITY_SIZE>;
+
+    static const size_t kOverheadSize = Code::kParitySize;
+    static const size_t kPayloadSizeLimit = FrameLink::kPayloadSizeLimit - kOverheadSize; // Warning: datagrams sent through this link must leave room for the parity bytes!
+
+    using ToReceive = ByteBufferView; // The type of data passed up from below
+    using Receive = FixedByteBuffer<FrameLink::kPayloadSizeLimit>; // The type of data passed up to above
+    using OptionalReceive = Util::Optional<Receive>;
+    using Send = ByteBufferView; // The type of data passed down from above
+    using SendDelegate = etl::delegate<bool(const Send &, DataUnitTypeCode)>;
+    using ToSend = ByteBufferView; // The type of data passed down to below
+    using ToSendDelegate = etl::delegate<bool(const ToSend &, DataUnitTypeCode)>;
+
+    FECLink(const ToSendDelegate &delegate) : sender(delegate) {}
+    FECLink(const FECLink &link) = delete; // prevent accidental copy-by-value
+
+    // Event loop interface
+
+    void setup() {}
+    void update() {}
+
+    // ByteBufferLink interface
+
+    OptionalReceive receive(const ByteBufferView &buffer) {
+      OptionalReceive received;
+      if (buffer.size() <= kOverheadSize) return received;
+
+      // Correct a copy of the codeword in place
+      received->resize(buffer.size());
+      memcpy(received->data(), buffer.data(), buffer.size());
+      int correctedSize = code.decode(received->data(), received->size());
+      if (correctedSize < 0) {
+        ++uncorrectableFrames;
+        return received;
+      }
+
+      correctedBytes += correctedSize;
+      received->resize(buffer.size() - kOverheadSize); // strip the parity bytes
+      received.enabled = true;
+      return received;
+    }
+
+    bool send(const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Transport::Datagram) {
+      if (payload.empty()) return false;
+      if (payload.size() > kPayloadSizeLimit) return false;
+
+      FixedCodeword codeword;
+      codeword.resize(payload.size() + kOverheadSize);
+      memcpy(codeword.data(), payload.data(), payload.size());
+      code.encode(codeword.data(), payload.size(), codeword.data() + payload.size());
+      return sender(ByteBufferView(codeword), type);
+    }
+
+    // FECLink interface
+
+    unsigned long corrected() const {
+      return correctedBytes;
+    }
+
+    unsigned long uncorrectable() const {
+      return uncorrectableFrames;
+    }
+
+  protected:
+    using FixedCodeword = FixedByteBuffer<FrameLink::kPayloadSizeLimit>;
+
+    const ToSendDelegate &sender;
+    const Code code;
+
+    unsigned long correctedBytes = 0;
+    unsigned long uncorrectableFrames = 0;
+};
+
+} } }
\ No newline at end of file
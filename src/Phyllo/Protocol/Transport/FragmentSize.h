@@ -0,0 +1,57 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libraries
+
+// Phyllo
+#include "ReliableBuffer.h"
+
+#ifndef PHYLLO_TRANSPORT_FRAGMENT_SIZE_MIN
+#define PHYLLO_TRANSPORT_FRAGMENT_SIZE_MIN 32 // Smallest reliableBuffer payload to fall back to on lossy links; set to PHYLLO_TRANSPORT_CHUNK_SIZE_LIMIT to disable tuning
+#endif
+
+// Fragment size tuner shrinks reliableBuffer payloads when frames are lost, since short frames are likelier to arrive intact
+
+namespace Phyllo { namespace Protocol { namespace Transport {
+
+class FragmentSizeTuner {
+  public:
+    static const size_t kMaxSize = ReliableBuffer::kPayloadSizeLimit;
+    static const size_t kMinSize = (PHYLLO_TRANSPORT_FRAGMENT_SIZE_MIN < kMaxSize) ? PHYLLO_TRANSPORT_FRAGMENT_SIZE_MIN : kMaxSize;
+    static const size_t kIncrease = 16; // bytes added after a clean run
+    static const unsigned int kCleanAcknowledgements = 16; // acknowledgements without loss which make a clean run
+
+    // FragmentSizeTuner interface
+
+    size_t size() const { // the largest payload to send in one reliableBuffer
+      return (current < limit) ? current : limit;
+    }
+
+    void setLimit(size_t limit) { // the largest payload the peer can receive
+      if (limit > kMaxSize) limit = kMaxSize;
+      if (limit < 1) limit = 1;
+      this->limit = limit;
+    }
+
+    void acknowledged() { // additive increase
+      if (++cleanAcknowledgements < kCleanAcknowledgements) return;
+
+      cleanAcknowledgements = 0;
+      current += kIncrease;
+      if (current > kMaxSize) current = kMaxSize;
+    }
+
+    void lost() { // multiplicative decrease
+      cleanAcknowledgements = 0;
+      current /= 2;
+      if (current < kMinSize) current = kMinSize;
+    }
+
+  protected:
+    size_t current = kMaxSize; // start optimistic, since most links are clean
+    size_t limit = kMaxSize;
+    unsigned int cleanAcknowledgements = 0;
+};
+
+} } }
\ No newline at end of file
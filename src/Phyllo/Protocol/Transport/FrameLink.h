@@ -44,6 +44,10 @@ class FrameLink {
     OptionalReceive receive(const ByteBufferView &buffer) {
       OptionalReceive received;
       if (buffer.empty()) return received;
+      if (!wellFormed(buffer)) {
+        ++malformedFrames; // e.g. a corrupted code byte, or a chunk which was cut short
+        return received;
+      }
 
       // Allow access of payload
       received->resize(kPayloadSizeLimit); // make receivedPayload look like an array for Encoder::decode
@@ -69,9 +73,28 @@ class FrameLink {
       return sendStatus;
     }
 
+    // FrameLink interface
+
+    static bool wellFormed(const ByteBufferView &buffer) {
+      // Each COBS code byte gives the distance to the next one, and the last one must point exactly past the end.
+      // This only reads the code bytes, so it's much cheaper than decoding and checking a CRC.
+      size_t position = 0;
+      while (position < buffer.size()) {
+        if (buffer[position] == ChunkedStreamLink::kChunkMarker) return false;
+        position += buffer[position];
+      }
+      return position == buffer.size();
+    }
+
+    unsigned long malformedCount() const { // frames which were discarded without decoding
+      return malformedFrames;
+    }
+
   protected:
     using FixedFrame = FixedByteBuffer<ChunkedStreamLink::kPayloadSizeLimit>;
     const ToSendDelegate &sender;
+
+    unsigned long malformedFrames = 0;
 };
 
 } } }
\ No newline at end of file
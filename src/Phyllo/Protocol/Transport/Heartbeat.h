@@ -0,0 +1,90 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libraries
+#include <etl/delegate.h>
+
+// Phyllo
+#include "Phyllo/Util/Timing.h"
+
+#ifndef PHYLLO_TRANSPORT_HEARTBEAT_INTERVAL
+#define PHYLLO_TRANSPORT_HEARTBEAT_INTERVAL 100 // ms without sending anything before a heartbeat is sent; 0 disables heartbeats
+#endif
+
+#ifndef PHYLLO_TRANSPORT_HEARTBEAT_TIMEOUT
+#define PHYLLO_TRANSPORT_HEARTBEAT_TIMEOUT 350 // ms without receiving anything before the peer is considered dead; 0 disables detection
+#endif
+
+// Heartbeat tracks peer liveness and decides when a link must prove its own liveness to the peer
+
+namespace Phyllo { namespace Protocol { namespace Transport {
+
+class Heartbeat {
+  public:
+    using LivenessDelegate = etl::delegate<void(bool)>; // called with true on link-up and false on link-down
+
+    static const unsigned long kInterval = PHYLLO_TRANSPORT_HEARTBEAT_INTERVAL;
+    static const unsigned long kTimeout = PHYLLO_TRANSPORT_HEARTBEAT_TIMEOUT;
+
+    Heartbeat() : idleTimer(kInterval), silenceTimer(kTimeout) {}
+
+    // Event loop interface
+
+    void setup() {
+      if (idleTimer.timeout) idleTimer.start();
+    }
+
+    void update() {
+      if (!alive || !silenceTimer.timedOut()) return;
+
+      silenceTimer.resetAndStop();
+      setAlive(false);
+    }
+
+    // Heartbeat interface
+
+    bool readyToSend() const {
+      return idleTimer.timedOut();
+    }
+
+    void sent() { // any traffic to the peer already proves our liveness
+      if (idleTimer.timeout) idleTimer.start();
+    }
+
+    void received() { // any traffic from the peer already proves its liveness
+      if (silenceTimer.timeout) silenceTimer.start();
+      if (!alive) setAlive(true);
+    }
+
+    bool peerAlive() const {
+      return alive;
+    }
+
+    void setTimeouts(unsigned long interval, unsigned long timeout) {
+      // The timeout should span a few intervals, so that a single lost heartbeat is not mistaken for a dead peer
+      idleTimer.timeout = interval;
+      silenceTimer.timeout = timeout;
+      if (interval) idleTimer.start();
+      else idleTimer.resetAndStop();
+      if (!timeout) silenceTimer.resetAndStop();
+    }
+
+    void setHandler(const LivenessDelegate &handler) {
+      this->handler = handler;
+    }
+
+  protected:
+    Util::TimeoutTimer idleTimer;
+    Util::TimeoutTimer silenceTimer;
+    bool alive = false;
+
+    LivenessDelegate handler;
+
+    void setAlive(bool alive) {
+      this->alive = alive;
+      if (handler.is_valid()) handler(alive);
+    }
+};
+
+} } }
\ No newline at end of file
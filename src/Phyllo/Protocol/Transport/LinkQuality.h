@@ -0,0 +1,94 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libraries
+
+// Phyllo
+#include "Phyllo/Util/Timing.h"
+
+#ifndef PHYLLO_TRANSPORT_QUALITY_PERIOD
+#define PHYLLO_TRANSPORT_QUALITY_PERIOD 1000 // ms per link quality evaluation
+#endif
+
+#ifndef PHYLLO_TRANSPORT_QUALITY_FAILURE_THRESHOLD
+#define PHYLLO_TRANSPORT_QUALITY_FAILURE_THRESHOLD 2 // failed data units in one period which indicate a bad link
+#endif
+
+#ifndef PHYLLO_TRANSPORT_QUALITY_RECOVERY_PERIODS
+#define PHYLLO_TRANSPORT_QUALITY_RECOVERY_PERIODS 10 // consecutive clean periods with traffic which indicate a good link
+#endif
+
+// Link quality monitor counts data units which failed validation to judge whether the link needs more or less protection
+
+namespace Phyllo { namespace Protocol { namespace Transport {
+
+class LinkQualityMonitor {
+  public:
+    enum class Verdict : uint8_t {
+      unchanged = 0,
+      degraded, // more protection is needed
+      recovered // less protection is needed
+    };
+
+    static const unsigned long kPeriod = PHYLLO_TRANSPORT_QUALITY_PERIOD;
+    static const unsigned int kFailureThreshold = PHYLLO_TRANSPORT_QUALITY_FAILURE_THRESHOLD;
+    static const unsigned int kRecoveryPeriods = PHYLLO_TRANSPORT_QUALITY_RECOVERY_PERIODS;
+
+    LinkQualityMonitor() : periodTimer(kPeriod) {}
+
+    // Event loop interface
+
+    void setup() {
+      periodTimer.start();
+    }
+
+    Verdict update() {
+      if (!periodTimer.timedOut()) return Verdict::unchanged;
+
+      Verdict verdict = Verdict::unchanged;
+      if (periodFailures >= kFailureThreshold) {
+        cleanPeriods = 0;
+        verdict = Verdict::degraded;
+      } else if (periodFailures) {
+        cleanPeriods = 0;
+      } else if (periodReceived && ++cleanPeriods >= kRecoveryPeriods) { // idle periods say nothing about the link
+        cleanPeriods = 0;
+        verdict = Verdict::recovered;
+      }
+      periodReceived = 0;
+      periodFailures = 0;
+      periodTimer.start();
+      return verdict;
+    }
+
+    // LinkQualityMonitor interface
+
+    void received() {
+      ++periodReceived;
+      ++totalReceived;
+    }
+
+    void failed() {
+      ++periodFailures;
+      ++totalFailures;
+    }
+
+    unsigned long receivedCount() const {
+      return totalReceived;
+    }
+
+    unsigned long failureCount() const {
+      return totalFailures;
+    }
+
+  protected:
+    Util::TimeoutTimer periodTimer;
+    unsigned int periodReceived = 0;
+    unsigned int periodFailures = 0;
+    unsigned int cleanPeriods = 0;
+    unsigned long totalReceived = 0;
+    unsigned long totalFailures = 0;
+};
+
+} } }
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libraries
+
+// Phyllo
+#include "Phyllo/Util/TokenBucket.h"
+#include "Phyllo/Util/Timing.h"
+
+#ifndef PHYLLO_TRANSPORT_PACING_RATE
+#define PHYLLO_TRANSPORT_PACING_RATE 0 // Maximum bytes/sec sent by a paced link; 0 disables pacing
+#endif
+
+#ifndef PHYLLO_TRANSPORT_PACING_MIN_RATE
+#define PHYLLO_TRANSPORT_PACING_MIN_RATE (PHYLLO_TRANSPORT_PACING_RATE / 32) // Floor for multiplicative decreases
+#endif
+
+#ifndef PHYLLO_TRANSPORT_PACING_BURST
+#define PHYLLO_TRANSPORT_PACING_BURST 256 // Bytes which may be sent back-to-back; must fit the largest data unit
+#endif
+
+// Pacer shapes output to a rate which backs off on loss and creeps up on acknowledgement (AIMD).
+// The rate never exceeds PHYLLO_TRANSPORT_PACING_RATE, a fixed ceiling which should be set to the link's drain rate.
+
+namespace Phyllo { namespace Protocol { namespace Transport {
+
+class AIMDPacer {
+  public:
+    static const unsigned long kMaxRate = PHYLLO_TRANSPORT_PACING_RATE;
+    static const unsigned long kMinRate = (PHYLLO_TRANSPORT_PACING_MIN_RATE > 0) ? PHYLLO_TRANSPORT_PACING_MIN_RATE : 1;
+    static const unsigned long kBurst = PHYLLO_TRANSPORT_PACING_BURST;
+    static const unsigned long kIncrease = (kMaxRate / 64 > 0) ? kMaxRate / 64 : 1; // bytes/sec per acknowledgement
+    static const unsigned long kDecreaseHoldTime = 100; // ms; loss signals within this time are from the same congestion event
+
+    AIMDPacer() : bucket(kMaxRate, kBurst), decreaseHold(kDecreaseHoldTime) {}
+
+    // Event loop interface
+
+    void setup() {}
+    void update() {}
+
+    // Pacer interface
+
+    bool enabled() const {
+      return bucket.limited();
+    }
+
+    bool readyToSend(size_t size) {
+      return bucket.available(size);
+    }
+
+    void sent(size_t size) {
+      bucket.consume(size);
+    }
+
+    void acknowledged() { // additive increase
+      if (!enabled()) return;
+
+      unsigned long rate = bucket.tokensPerSecond() + kIncrease;
+      if (rate > kMaxRate) rate = kMaxRate;
+      bucket.setRate(rate);
+    }
+
+    void congested() { // multiplicative decrease, e.g. on loss or when the lower link can't drain fast enough
+      if (!enabled() || decreaseHold.running()) return;
+
+      unsigned long rate = bucket.tokensPerSecond() / 2;
+      if (rate < kMinRate) rate = kMinRate;
+      bucket.setRate(rate);
+      decreaseHold.start();
+    }
+
+    unsigned long rate() const { // bytes/sec; 0 if pacing is disabled
+      return bucket.tokensPerSecond();
+    }
+
+  protected:
+    Util::TokenBucket bucket;
+    Util::TimeoutTimer decreaseHold;
+};
+
+} } }
\ No newline at end of file
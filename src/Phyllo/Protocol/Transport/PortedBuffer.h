@@ -0,0 +1,119 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libraries
+
+// Phyllo
+#include "Phyllo/Types.h"
+#include "Phyllo/Util/Struct.h"
+#include "Phyllo/Protocol/Types.h"
+#include "ReliableBuffer.h"
+
+// PortedBuffers carry a port number so that independent channels can share one link
+
+namespace Phyllo { namespace Protocol { namespace Transport {
+
+class PortedBufferHeader {
+  public:
+    using Port = uint8_t;
+
+    using PortField = Util::StructField<Port, 0>; // 1 byte
+    using TypeField = Util::StructField<DataUnitTypeCode, PortField::kAfterOffset>; // 1 byte
+
+    static const size_t kSize = PortField::kSize + TypeField::kSize;
+
+    PortField port = 0;
+    TypeField type = DataUnitType::Bytes::Buffer;
+
+    bool read(const ByteBufferView &buffer) {
+      if (buffer.size() < kSize) return false;
+
+      port.read(buffer);
+      type.read(buffer);
+      return true;
+    }
+
+    bool write(ByteBuffer &buffer) const {
+      if (buffer.size() < kSize) return false;
+
+      port.write(buffer);
+      type.write(buffer);
+      return true;
+    };
+};
+
+class PortedBuffer {
+  public:
+    using Port = PortedBufferHeader::Port;
+
+    static const DataUnitTypeCode kType = DataUnitType::Transport::PortedBuffer;
+    static const size_t kHeaderSize = PortedBufferHeader::kSize;
+    static const size_t kFooterSize = 0;
+    static const size_t kOverheadSize = kHeaderSize + kFooterSize;
+    static const size_t kPayloadSizeLimit = ReliableBuffer::kPayloadSizeLimit - kOverheadSize; // fits in every logical stack
+
+    PortedBufferHeader header;
+
+    PortedBuffer() {}
+
+    ByteBufferView payload() const {
+      return ByteBufferView(dumpBuffer.begin() + kHeaderSize, dumpBuffer.end() - kFooterSize);
+    }
+    ByteBufferView buffer() const {
+      return ByteBufferView(dumpBuffer);
+    }
+
+    // Methods for updating portedBuffer or portedBuffer payload
+
+    bool read(const ByteBufferView &buffer) {
+      // Parse a given buffer, update the own header and payload, and dump to own buffer
+      if (buffer.size() < kOverheadSize) return false;
+      if (buffer.size() > kOverheadSize + kPayloadSizeLimit) return false;
+      if (!header.read(buffer)) return false;
+
+      // Dump payload and header into own buffer
+      ByteBufferView payload(buffer.begin() + kHeaderSize, buffer.end() - kFooterSize);
+
+      return dump(payload);
+    }
+
+    bool write(const ByteBufferView &payload) {
+      // Write a payload, update the header for consistency, and dump to own buffer
+      if (payload.empty()) return false;
+      if (payload.size() > kPayloadSizeLimit) return false;
+
+      return dump(payload);
+    }
+
+    PortedBuffer &operator=(const PortedBuffer &portedBuffer) {
+      header = portedBuffer.header;
+      dumpBuffer.resize(portedBuffer.buffer().size());
+      memcpy(dumpBuffer.data(), portedBuffer.buffer().data(), portedBuffer.buffer().size());
+      return *this;
+    }
+
+  protected:
+    using DumpBuffer = FixedByteBuffer<kOverheadSize + kPayloadSizeLimit>;
+    DumpBuffer dumpBuffer;
+
+    bool dump(const ByteBufferView &payload) {
+      dumpBuffer.resize(kOverheadSize + payload.size());
+      memcpy(dumpBuffer.begin() + kHeaderSize, payload.data(), payload.size());
+
+      return header.write(dumpBuffer);
+    }
+};
+
+} } }
+
+namespace Phyllo {
+
+ByteBufferView getPayload(const Protocol::Transport::PortedBuffer &ported) {
+    return ported.payload();
+}
+Protocol::DataUnitTypeCode getPayloadType(const Protocol::Transport::PortedBuffer &ported) {
+    return ported.header.type;
+}
+
+}
\ No newline at end of file
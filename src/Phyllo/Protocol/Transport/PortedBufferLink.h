@@ -0,0 +1,238 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libraries
+#include <etl/delegate.h>
+#include <etl/queue.h>
+
+// Phyllo
+#include "Phyllo/Types.h"
+#include "Phyllo/Util/Optional.h"
+#include "Phyllo/Util/Timing.h"
+#include "Phyllo/Protocol/Types.h"
+#include "PortedBuffer.h"
+
+#ifndef PHYLLO_TRANSPORT_PORT_COUNT
+#define PHYLLO_TRANSPORT_PORT_COUNT 4 // Number of independent channels; each costs PHYLLO_TRANSPORT_PORT_QUEUE_SIZE buffers of RAM
+#endif
+
+#ifndef PHYLLO_TRANSPORT_PORT_QUEUE_SIZE
+#define PHYLLO_TRANSPORT_PORT_QUEUE_SIZE 2 // Received portedBuffers held per port until its consumer reads them
+#endif
+
+// Ported Buffer layer multiplexes independent channels, each with its own receive queue, over one link.
+// On reliable ports, the receiver advertises how many more portedBuffers its queue has room for, and the sender
+// refuses sends beyond that, so a slow consumer never makes the receiver drop what the ARQ already acknowledged.
+// Unreliable ports aren't flow-controlled: when a port's queue is full, its newly received portedBuffers are dropped.
+// Both peers should agree on which ports are reliable, since only those get their windows advertised unasked.
+
+namespace Phyllo { namespace Protocol { namespace Transport {
+
+class PortedBufferLink {
+  public:
+    using Port = PortedBuffer::Port;
+
+    static const size_t kPortCount = PHYLLO_TRANSPORT_PORT_COUNT;
+    static const size_t kQueueSize = PHYLLO_TRANSPORT_PORT_QUEUE_SIZE;
+    static_assert(kPortCount > 0 && kPortCount <= 256, "Port count must be between 1 and 256!");
+    static const DataUnitTypeCode kWindowType = 0x0c; // layer-defined type for a port's receive window advertisement
+    static const DataUnitTypeCode kProbeType = 0x0d; // layer-defined type for asking for a closed port window
+    static const unsigned long kProbeInterval = 200; // ms between probes while a port's window is closed
+    static_assert(kQueueSize > 0, "Port queue size must be positive!");
+    static_assert(kQueueSize < 0x80, "Port queue size must fit in half of the count space!");
+
+    using ToReceive = ByteBufferView; // The type of data passed up from below
+    using Receive = PortedBuffer; // The type of data passed up to above
+    using OptionalReceive = Util::Optional<Receive>;
+    using Send = ByteBufferView; // The type of data passed down from above
+    using ToSend = ByteBufferView; // The type of data passed down to below
+    using ToSendDelegate = etl::delegate<bool(const ToSend &, DataUnitTypeCode)>;
+
+    PortedBufferLink(const ToSendDelegate &delegate) :
+      PortedBufferLink(delegate, delegate) {}
+    PortedBufferLink(const ToSendDelegate &reliableDelegate, const ToSendDelegate &unreliableDelegate) :
+      reliableSender(reliableDelegate), unreliableSender(unreliableDelegate), probeTimer(kProbeInterval) {
+        for (size_t i = 0; i < kPortCount; ++i) {
+          reliablePorts[i] = true;
+          peerEdges[i] = 1; // every peer has room for one portedBuffer before it has advertised its window
+          advertisedEdges[i] = 1;
+        }
+      }
+    PortedBufferLink(const PortedBufferLink &link) = delete; // prevent accidental copy-by-value
+
+    // Event loop interface
+
+    void setup() {}
+    void update() {
+      if (probeTimer.timedOut()) probe(); // in case a window advertisement was lost
+      for (size_t port = 0; port < kPortCount; ++port) {
+        if (!reliablePorts[port]) continue;
+        if (Count(windowEdge(port) - advertisedEdges[port]) >= kAdvertiseThreshold) advertise(port);
+      }
+    }
+
+    // ByteBufferLink interface
+
+    bool receive(const ByteBufferView &buffer, DataUnitTypeCode type) {
+      // Returns whether the buffer was a portedBuffer or window, so that other traffic can be passed along
+      if (type == kWindowType || type == kProbeType) {
+        if (buffer.size() < kWindowSize || buffer[0] >= kPortCount) ++malformedBuffers;
+        else if (type == kWindowType) receiveWindow(buffer[0], buffer[1]);
+        else { // the sender is asking for a closed window, and tells us how many it sent before asking
+          receiveCounts[buffer[0]] = buffer[1];
+          advertise(buffer[0]);
+        }
+        return true;
+      }
+      if (type != PortedBuffer::kType) return false;
+
+      PortedBuffer received;
+      if (!received.read(buffer) || received.header.port >= kPortCount) {
+        ++malformedBuffers;
+        return true;
+      }
+
+      Queue &queue = queues[received.header.port];
+      ++receiveCounts[received.header.port];
+      if (queue.full()) { // on unreliable ports or if the peer ignored our window; other ports are never blocked
+        ++overflows[received.header.port];
+        return true;
+      }
+
+      queue.push(received);
+      return true;
+    }
+
+    bool send(Port port, const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Bytes::Buffer) {
+      if (port >= kPortCount) return false;
+
+      PortedBuffer portedBuffer;
+      portedBuffer.header.port = port;
+      portedBuffer.header.type = type;
+      if (!portedBuffer.write(payload)) return false;
+
+      if (!reliablePorts[port]) return unreliableSender(portedBuffer.buffer(), PortedBuffer::kType);
+
+      if (!windowAvailable(port)) { // wait for the peer's consumer to read
+        blockedPorts[port] = true;
+        if (!probeTimer.enabled) probeTimer.start();
+        return false;
+      }
+      if (!reliableSender(portedBuffer.buffer(), PortedBuffer::kType)) return false;
+
+      ++sendCounts[port];
+      return true;
+    }
+
+    // Peek interface
+
+    bool hasRead(Port port) const {
+      return port < kPortCount && !queues[port].empty();
+    }
+
+    const PortedBuffer &peek(Port port) const {
+      // This doesn't check if anything was received - call hasRead() first to check that!
+      return queues[port].front();
+    }
+
+    void consume(Port port) {
+      if (hasRead(port)) queues[port].pop();
+    }
+
+    OptionalReceive read(Port port) {
+      OptionalReceive received;
+      if (!hasRead(port)) return received;
+
+      received = peek(port);
+      consume(port);
+      return received;
+    }
+
+    // PortedBufferLink interface
+
+    void setReliable(Port port, bool reliable) { // ports are reliable by default, where the logical stack supports it
+      if (port < kPortCount) reliablePorts[port] = reliable;
+    }
+
+    size_t windowAvailable(Port port) const { // portedBuffers which the peer has room to receive on a reliable port
+      if (port >= kPortCount) return 0;
+
+      Count window = peerEdges[port] - sendCounts[port];
+      return (window < 0x80) ? window : 0;
+    }
+
+    size_t queued(Port port) const {
+      if (port >= kPortCount) return 0;
+
+      return queues[port].size();
+    }
+
+    unsigned long overflowCount(Port port) const { // received portedBuffers dropped because the port's queue was full
+      if (port >= kPortCount) return 0;
+
+      return overflows[port];
+    }
+
+    unsigned long malformedCount() const { // portedBuffers which were too short or had an unknown port
+      return malformedBuffers;
+    }
+
+  protected:
+    using Queue = etl::queue<PortedBuffer, kQueueSize>;
+    using Count = uint8_t; // portedBuffers sent or received on a port, wrapping around
+
+    static const size_t kWindowSize = 2; // port, then window edge or send count
+    static const Count kAdvertiseThreshold = (kQueueSize / 2) ? (kQueueSize / 2) : 1; // freed slots worth advertising
+
+    const ToSendDelegate &reliableSender;
+    const ToSendDelegate &unreliableSender;
+
+    Queue queues[kPortCount];
+    bool reliablePorts[kPortCount];
+    unsigned long overflows[kPortCount] = {};
+    unsigned long malformedBuffers = 0;
+
+    Count sendCounts[kPortCount] = {};
+    Count peerEdges[kPortCount];
+    bool blockedPorts[kPortCount] = {};
+    Util::TimeoutTimer probeTimer;
+    Count receiveCounts[kPortCount] = {};
+    Count advertisedEdges[kPortCount];
+
+    Count windowEdge(Port port) const {
+      return receiveCounts[port] + (kQueueSize - queues[port].size());
+    }
+
+    void advertise(Port port) {
+      const uint8_t window[kWindowSize] = {port, windowEdge(port)};
+      if (reliableSender(ByteBufferView(window, kWindowSize), kWindowType)) { // otherwise update() will try again
+        advertisedEdges[port] = window[1];
+      }
+    }
+
+    void receiveWindow(Port port, Count edge) {
+      if (Count(edge - peerEdges[port]) >= 0x80) return; // stale, e.g. reordered below an unreliable logical stack
+
+      peerEdges[port] = edge;
+      if (windowAvailable(port)) blockedPorts[port] = false;
+    }
+
+    void probe() {
+      bool blocked = false;
+      for (size_t port = 0; port < kPortCount; ++port) {
+        if (!blockedPorts[port] || windowAvailable(port)) {
+          blockedPorts[port] = false;
+          continue;
+        }
+
+        const uint8_t count[kWindowSize] = {static_cast<uint8_t>(port), sendCounts[port]};
+        reliableSender(ByteBufferView(count, kWindowSize), kProbeType);
+        blocked = true;
+      }
+      if (blocked) probeTimer.start();
+      else probeTimer.resetAndStop();
+    }
+};
+
+} } }
\ No newline at end of file
@@ -10,6 +10,10 @@
 #include "Phyllo/Util/Struct.h"
 #include "Datagram.h"
 
+#ifndef PHYLLO_TRANSPORT_RELIABLE_EXTENDED_HEADER
+#define PHYLLO_TRANSPORT_RELIABLE_EXTENDED_HEADER 0 // Set to 1 to allow negotiation of 16-bit sequence numbers, at the cost of 2 bytes of payload capacity
+#endif
+
 // ReliableBuffers are used to send discrete units of data reliably over a validated datagram link
 // in which datagrams are vulnerable to loss (data corruption detectable by CRCs in validated datagrams)
 
@@ -60,12 +64,19 @@ class ReliableBufferFlags {
 
 class ReliableBufferHeader {
   public:
-    using SequenceNumber = uint8_t;
+    using SequenceNumber = uint16_t; // tracked at full width, but only the low byte is sent unless the header is extended
+    using SequenceNumberByte = uint8_t;
+
+    static const size_t kSequenceNumberSpace = 256;
+    static const size_t kExtendedSequenceNumberSpace = 65536;
 
-    using SeqNumField = Util::StructField<SequenceNumber, 0>; // 1 byte
-    using AckNumField = Util::StructField<SequenceNumber, SeqNumField::kAfterOffset>; // 1 byte; expected sequence number of next reliableBuffer to be received
+    using SeqNumField = Util::StructField<SequenceNumber, 0, SequenceNumberByte>; // 1 byte
+    using AckNumField = Util::StructField<SequenceNumber, SeqNumField::kAfterOffset, SequenceNumberByte>; // 1 byte; expected sequence number of next reliableBuffer to be received
     using FlagsField = Util::StructField<ReliableBufferFlags, AckNumField::kAfterOffset, ReliableBufferFlags::Bitfield>; // 1 byte
     using TypeField = Util::StructField<DataUnitTypeCode, FlagsField::kAfterOffset>; // 1 byte
+    // Header extension, only present if the ext flag is set:
+    using SeqNumHighField = Util::StructField<SequenceNumberByte, TypeField::kAfterOffset>; // 1 byte; high byte of the sequence number
+    using AckNumHighField = Util::StructField<SequenceNumberByte, SeqNumHighField::kAfterOffset>; // 1 byte; high byte of the acknowledgement number
 
     static const size_t kSize = (
       0
@@ -74,12 +85,18 @@ class ReliableBufferHeader {
       + FlagsField::kSize
       + TypeField::kSize
     );
+    static const size_t kExtensionSize = SeqNumHighField::kSize + AckNumHighField::kSize;
+    static const size_t kExtendedSize = kSize + kExtensionSize;
 
     SeqNumField seqNum = 0;
     AckNumField ackNum = 0;
     FlagsField flags;
     TypeField type = DataUnitType::Bytes::Buffer;
 
+    size_t size() const {
+      return flags.value.ext ? kExtendedSize : kSize;
+    }
+
     bool read(const ByteBufferView &buffer) {
       if (buffer.size() < kSize) return false; // TODO: handle error
 
@@ -87,16 +104,25 @@ class ReliableBufferHeader {
       ackNum.read(buffer);
       flags.read(buffer);
       type.read(buffer);
+      if (!flags.value.ext) return true;
+
+      if (buffer.size() < kExtendedSize) return false; // TODO: handle error
+      seqNum = seqNum | (SequenceNumber(SeqNumHighField::parse(buffer)) << 8);
+      ackNum = ackNum | (SequenceNumber(AckNumHighField::parse(buffer)) << 8);
       return true;
     }
 
     bool write(ByteBuffer &buffer) {
-      if (buffer.size() < kSize) return false;
+      if (buffer.size() < size()) return false;
 
       seqNum.write(buffer);
       ackNum.write(buffer);
       flags.write(buffer);
       type.write(buffer);
+      if (!flags.value.ext) return true;
+
+      SeqNumHighField(seqNum >> 8).write(buffer);
+      AckNumHighField(ackNum >> 8).write(buffer);
       return true;
     };
 };
@@ -107,14 +133,16 @@ class ReliableBuffer {
     static const size_t kHeaderSize = ReliableBufferHeader::kSize;
     static const size_t kFooterSize = 0;
     static const size_t kOverheadSize = kHeaderSize + kFooterSize;
-    static const size_t kPayloadSizeLimit = Datagram::kPayloadSizeLimit - kOverheadSize;
+    static const bool kExtendedHeaderSupported = PHYLLO_TRANSPORT_RELIABLE_EXTENDED_HEADER;
+    static const size_t kExtensionSize = kExtendedHeaderSupported ? ReliableBufferHeader::kExtensionSize : 0;
+    static const size_t kPayloadSizeLimit = ValidatedDatagram::kPayloadSizeLimit - kOverheadSize - kExtensionSize; // reliableBuffers are carried in validatedDatagrams
 
     ReliableBufferHeader header;
 
     ReliableBuffer() {}
 
     ByteBufferView payload() const {
-      return ByteBufferView(dumpBuffer.begin() + kHeaderSize, dumpBuffer.end() - kFooterSize);
+      return ByteBufferView(dumpBuffer.begin() + header.size(), dumpBuffer.end() - kFooterSize);
     }
     ByteBufferView buffer() const {
       return ByteBufferView(dumpBuffer);
@@ -128,7 +156,7 @@ class ReliableBuffer {
       if (!header.read(buffer)) return false;
 
       // Dump payload and header into own buffer
-      ByteBufferView payload(buffer.begin() + kHeaderSize, buffer.end() - kFooterSize);
+      ByteBufferView payload(buffer.begin() + header.size(), buffer.end() - kFooterSize);
 
       return dump(payload);
     }
@@ -143,7 +171,7 @@ class ReliableBuffer {
 
     bool writeEmpty() {
       // Write an empty payload, update the header for consistency, and dump to own buffer
-      dumpBuffer.resize(kOverheadSize);
+      dumpBuffer.resize(header.size() + kFooterSize);
       return header.write(dumpBuffer);
     }
 
@@ -159,8 +187,8 @@ class ReliableBuffer {
     DumpBuffer dumpBuffer;
 
     bool dump(const ByteBufferView &payload) {
-      dumpBuffer.resize(kOverheadSize + payload.size());
-      memcpy(dumpBuffer.begin() + kHeaderSize, payload.data(), payload.size());
+      dumpBuffer.resize(header.size() + payload.size() + kFooterSize);
+      memcpy(dumpBuffer.begin() + header.size(), payload.data(), payload.size());
       
       return header.write(dumpBuffer);
     }
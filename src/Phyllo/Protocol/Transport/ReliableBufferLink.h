@@ -8,9 +8,13 @@
 // Phyllo
 #include "Phyllo/Types.h"
 #include "Phyllo/Util/Optional.h"
+#include "Phyllo/Util/Timing.h"
 #include "DatagramLink.h"
 #include "ReliableBuffer.h"
 #include "ARQ.h"
+#include "Heartbeat.h"
+#include "Pacer.h"
+#include "FragmentSize.h"
 
 // ReliableBuffer layer handles reliableBuffer resending
 // WARNING: implementation is incomplete!
@@ -19,16 +23,27 @@ namespace Phyllo { namespace Protocol { namespace Transport {
 
 class ReliableBufferLink {
   public:
+    enum class Session : uint8_t {
+      closed = 0, // no session; reliable sends are refused until a session is (re)opened
+      synchronizing, // syn sent, waiting for the peer's syn-ack
+      established
+    };
+
+    static const unsigned int kSynchronizeTimeout = 200; // ms between syn retransmissions
+    static const DataUnitTypeCode kFragmentType = 0x09; // layer-defined type for all but the last fragment of a payload
+    static const DataUnitTypeCode kUrgentType = 0x0a; // layer-defined type for urgent payloads, whose first byte is their own type
+    static const size_t kUrgentPayloadSizeLimit = ReliableBuffer::kPayloadSizeLimit - 1;
+
     using ToReceive = ByteBufferView; // The type of data passed up from below
     using Receive = ReliableBuffer; // The type of data passed up to above
     using OptionalReceive = Util::Optional<Receive>;
     using Send = ByteBufferView; // The type of data passed down from above
-    using SendDelegate = etl::delegate<bool(const Send &, DataUnitTypeCode, bool)>;
+    using SendDelegate = etl::delegate<bool(const Send &, DataUnitTypeCode)>;
     using ToSend = ByteBufferView; // The type of data passed down to below
     using ToSendDelegate = etl::delegate<bool(const ToSend &, DataUnitTypeCode)>;
 
     ReliableBufferLink(const ToSendDelegate &delegate) : 
-      arqReceiver(delegate), sender(delegate) {}
+      arqReceiver(delegate), synchronizeTimer(kSynchronizeTimeout), sender(delegate) {}
 
     ReliableBufferLink(const ReliableBufferLink &reliableBufferLink) = delete; // prevent accidental copy-by-value
 
@@ -37,11 +52,18 @@ class ReliableBufferLink {
     void setup() {
       arqSender.setup();
       arqReceiver.setup();
+      heartbeat.setup();
+      synchronize(); // the peer's sequence state may be stale from before we were reset
     }
 
     void update() {
+      if (synchronizeTimer.timedOut()) sendSession(resetPending); // a lost reset must be resent as a reset
+      heartbeat.update();
+      if (heartbeat.readyToSend() && session != Session::closed) sendHeartbeat();
       arqReceiver.update();
-      arqSender.update(); // TODO: send the next datagramToSend in arqSender if it's readyToSend
+      arqSender.update();
+      checkLosses();
+      sendQueued();
     }
 
     // ByteBufferLink interface 
@@ -54,44 +76,333 @@ class ReliableBufferLink {
         || !received->read(buffer)
       ) return received;
 
+      heartbeat.received();
+      if (receiveSession(*received)) {
+        received.enabled = false; // session reliableBuffers are only used by this link
+        return received;
+      }
+
+      GBNSender::SequenceNumber sendBase = arqSender.base();
       arqSender.receive(*received);
-      received.enabled = arqReceiver.receive(*received);
+      if (arqSender.base() != sendBase) {
+        pacer.acknowledged();
+        fragmentSizer.acknowledged();
+      }
+      checkLosses();
+      received.enabled = (
+        arqReceiver.receive(*received)
+        && received->header.type != DataUnitType::Layer::Control // control reliableBuffers are only used by this link
+      );
+      receivedReliable = !received->header.flags.value.nos;
+      if (received.enabled && receivedReliable) {
+        // Urgent payloads may arrive between the fragments of another payload, but are never fragmented themselves
+        if (received->header.type == kUrgentType) received.enabled = unwrapUrgent(*received);
+        else received.enabled = reassemble(*received);
+      }
       arqReceiver.update();
+      sendQueued(); // acknowledgements may have opened up the send window
       return received;
     }
 
     bool send(
       const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Bytes::Buffer, bool reliable = true
-    ) { // TODO: implement unreliable transmission option
+    ) {
       if (payload.empty()) return false;
       if (payload.size() > ReliableBuffer::kPayloadSizeLimit) return false;
+      if (type == kFragmentType || type == kUrgentType) return false;
 
       ReliableBuffer reliableBuffer;
-      reliableBuffer.header.seqNum = counter; // TODO: outsource this to GBNSender as updateSend
-      arqReceiver.prepare(reliableBuffer.header); // update the acknowledgement-related fields
-      if (!reliableBuffer.write(payload)) return false;
-      reliableBuffer.write(payload);
+      reliableBuffer.header.type = type;
+      if (!reliable) return sendUnsequenced(reliableBuffer, payload); // fails if the pacer has no room, for backpressure
+      if (session == Session::closed) return false;
 
-      if (!sender(reliableBuffer.buffer(), ReliableBuffer::kType)) return false; // TODO: actually we just want to queue into arqSender
-      
-      counter = (counter + 1) % 256; // TODO: outsource this to GBNSender with enqueue
-      arqReceiver.sent(reliableBuffer.header);
+      if (!enqueueFragments(payload, type)) return false;
+
+      sendQueued();
       return true;
     }
 
     // ReliableBufferLink interface
 
+    bool sendReliable(const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Bytes::Buffer) {
+      return send(payload, type, true);
+    }
+
+    bool sendUnreliable(const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Bytes::Buffer) {
+      // Unreliable reliableBuffers are sent immediately without being queued for retransmission,
+      // so they never wait behind in-flight reliable reliableBuffers
+      return send(payload, type, false);
+    }
+
+    bool sendUrgent(const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Bytes::Buffer) {
+      // Urgent payloads are sent reliably ahead of queued fragments of earlier payloads, so they only wait
+      // for the reliableBuffers already in flight
+      if (payload.empty() || payload.size() > kUrgentPayloadSizeLimit) return false;
+      if (session == Session::closed) return false;
+
+      FixedByteBuffer<ReliableBuffer::kPayloadSizeLimit> tagged;
+      tagged.resize(payload.size() + 1);
+      tagged[0] = type;
+      memcpy(tagged.data() + 1, payload.data(), payload.size());
+      ReliableBuffer reliableBuffer;
+      reliableBuffer.header.type = kUrgentType;
+      if (!reliableBuffer.write(ByteBufferView(tagged))) return false;
+      if (!arqSender.enqueueUrgent(reliableBuffer)) return false;
+
+      sendQueued();
+      return true;
+    }
+
+    bool readyToSend(size_t payloadSize = 1) {
+      // Publishers can poll this to hold back data instead of having sends fail or overrunning the pacer
+      size_t size = (payloadSize < fragmentSizer.size()) ? payloadSize : fragmentSizer.size();
+      return arqSender.readyToEnqueue() && pacer.readyToSend(
+        size + ReliableBuffer::kOverheadSize + ReliableBuffer::kExtensionSize
+      );
+    }
+
+    unsigned long pacingRate() const { // bytes/sec; 0 if pacing is disabled
+      return pacer.rate();
+    }
+
+    size_t fragmentSize() const { // the largest payload currently sent in one reliableBuffer
+      return fragmentSizer.size();
+    }
+
     bool reliableReceived() const {
-      return true; // TODO: implement by checking the header's seq flag
+      return receivedReliable;
+    }
+
+    bool extendedHeader() const {
+      // The extended header is only used once both peers have offered to use it
+      return ReliableBuffer::kExtendedHeaderSupported && peerExtendedHeader;
+    }
+
+    // Session interface
+
+    void synchronize() {
+      // Fast resynchronization: both peers realign their receivers to the other's send base
+      // in one round trip, and reliableBuffers already queued are kept and resent
+      session = Session::synchronizing;
+      sendSession(resetPending);
+    }
+
+    void reset() {
+      // Both peers drop their queued reliableBuffers and restart their sequence numbers from zero
+      arqSender.reset();
+      session = Session::synchronizing;
+      resetPending = true; // until the peer acknowledges it, since it must reset too
+      sendSession(true);
+    }
+
+    void close() {
+      arqSender.reset();
+      session = Session::closed;
+      resetPending = false;
+      synchronizeTimer.resetAndStop();
+      ReliableBuffer reliableBuffer;
+      arqReceiver.prepare(reliableBuffer.header);
+      reliableBuffer.header.flags.value.fin = true;
+      sendControl(reliableBuffer);
+    }
+
+    // Liveness interface
+
+    bool peerAlive() const {
+      return heartbeat.peerAlive();
+    }
+
+    void setHeartbeat(unsigned long interval, unsigned long timeout) {
+      heartbeat.setTimeouts(interval, timeout);
+    }
+
+    void setLivenessHandler(const Heartbeat::LivenessDelegate &handler) {
+      // e.g. to pause publishers on link-down, or to flush queues on link-up
+      heartbeat.setHandler(handler);
+    }
+
+    Session state() const {
+      return session;
+    }
+
+    bool established() const {
+      return session == Session::established;
     }
 
   protected:
     GBNSender arqSender;
     GBNReceiver arqReceiver;
 
-    uint8_t counter = 0;
+    Session session = Session::closed;
+    bool resetPending = false; // our sequence numbers restarted from zero, but the peer hasn't acknowledged it yet
+    Util::TimeoutTimer synchronizeTimer;
+    Heartbeat heartbeat;
+    AIMDPacer pacer;
+    FragmentSizeTuner fragmentSizer;
+    FixedByteBuffer<ReliableBuffer::kPayloadSizeLimit> reassembly;
+    bool reassemblyOverflowed = false;
+    unsigned long losses = 0;
+    bool peerExtendedHeader = false;
+    bool receivedReliable = false;
 
     const ToSendDelegate &sender;
+
+    bool transmit(const ReliableBuffer &reliableBuffer) {
+      if (!sender(reliableBuffer.buffer(), ReliableBuffer::kType)) {
+        pacer.congested(); // the lower link isn't draining as fast as we're sending
+        return false;
+      }
+
+      heartbeat.sent();
+      pacer.sent(reliableBuffer.buffer().size());
+      return true;
+    }
+
+    void checkLosses() {
+      if (arqSender.lossCount() == losses) return;
+
+      losses = arqSender.lossCount();
+      pacer.congested();
+      fragmentSizer.lost();
+    }
+
+    bool enqueueFragments(const ByteBufferView &payload, DataUnitTypeCode type) {
+      // Payloads are split into fragments of the tuned size, all of which must fit in the send queue
+      size_t fragmentSize = fragmentSizer.size();
+      size_t fragments = (payload.size() + fragmentSize - 1) / fragmentSize;
+      if (fragments > arqSender.enqueueAvailable()) return false;
+
+      for (size_t offset = 0; offset < payload.size(); offset += fragmentSize) {
+        size_t size = payload.size() - offset;
+        if (size > fragmentSize) size = fragmentSize;
+        ReliableBuffer reliableBuffer;
+        reliableBuffer.header.type = (offset + size < payload.size()) ? kFragmentType : type;
+        if (!reliableBuffer.write(ByteBufferView(payload.data() + offset, size))) return false;
+        arqSender.enqueue(reliableBuffer);
+      }
+      return true;
+    }
+
+    bool reassemble(ReliableBuffer &reliableBuffer) {
+      // Returns whether reliableBuffer now holds a complete payload; fragments arrive in order, since ARQ is GBN
+      bool last = reliableBuffer.header.type != kFragmentType;
+      if (last && reassembly.empty() && !reassemblyOverflowed) return true; // payload wasn't fragmented
+
+      ByteBufferView payload = reliableBuffer.payload();
+      if (payload.size() > reassembly.available()) reassemblyOverflowed = true;
+      if (!reassemblyOverflowed) {
+        size_t size = reassembly.size();
+        reassembly.resize(size + payload.size());
+        memcpy(reassembly.data() + size, payload.data(), payload.size());
+      }
+      if (!last) return false;
+
+      bool complete = !reassemblyOverflowed && reliableBuffer.write(ByteBufferView(reassembly));
+      reassembly.clear();
+      reassemblyOverflowed = false;
+      return complete;
+    }
+
+    bool unwrapUrgent(ReliableBuffer &reliableBuffer) {
+      ByteBufferView tagged = reliableBuffer.payload();
+      if (tagged.size() < 2) return false;
+
+      FixedByteBuffer<ReliableBuffer::kPayloadSizeLimit> payload;
+      payload.resize(tagged.size() - 1);
+      memcpy(payload.data(), tagged.data() + 1, payload.size());
+      reliableBuffer.header.type = tagged[0];
+      return reliableBuffer.write(ByteBufferView(payload));
+    }
+
+    void sendQueued() {
+      while (arqSender.readyToSend()) {
+        const ReliableBuffer &queued = arqSender.reliableBufferToSend();
+        ReliableBuffer reliableBuffer;
+        reliableBuffer.header.seqNum = arqSender.seqNumToSend();
+        reliableBuffer.header.type = queued.header.type;
+        arqReceiver.prepare(reliableBuffer.header); // update the acknowledgement-related fields
+        if (!reliableBuffer.write(queued.payload())) return;
+        if (!pacer.readyToSend(reliableBuffer.buffer().size())) return; // update() will send it once the pacer allows
+
+        if (!transmit(reliableBuffer)) return; // TODO: handle error
+        arqSender.sent();
+        arqReceiver.sent(reliableBuffer.header);
+      }
+    }
+
+    bool sendUnsequenced(ReliableBuffer &reliableBuffer, const ByteBufferView &payload) {
+      arqReceiver.prepare(reliableBuffer.header); // piggyback the acknowledgement-related fields
+      reliableBuffer.header.flags.value.nos = true;
+      if (!reliableBuffer.write(payload)) return false;
+      if (!pacer.readyToSend(reliableBuffer.buffer().size())) return false;
+
+      if (!transmit(reliableBuffer)) return false;
+      arqReceiver.sent(reliableBuffer.header);
+      return true;
+    }
+
+    bool sendControl(ReliableBuffer &reliableBuffer, const ByteBufferView &payload = ByteBufferView()) {
+      // Acknowledgement-related fields must already have been prepared by arqReceiver
+      reliableBuffer.header.flags.value.nos = true;
+      reliableBuffer.header.type = DataUnitType::Layer::Control;
+      if (payload.empty()) reliableBuffer.writeEmpty();
+      else if (!reliableBuffer.write(payload)) return false;
+      if (!transmit(reliableBuffer)) return false; // TODO: handle error
+      arqReceiver.sent(reliableBuffer.header);
+      return true;
+    }
+
+    void sendHeartbeat() {
+      // An empty control reliableBuffer, which also refreshes the peer's acknowledgement state
+      ReliableBuffer reliableBuffer;
+      arqReceiver.prepare(reliableBuffer.header);
+      if (!sendControl(reliableBuffer)) heartbeat.sent(); // don't retry on every update if the link is backed up
+    }
+
+    void sendSession(bool reset, bool acknowledge = false) {
+      ReliableBuffer reliableBuffer;
+      ReliableBufferFlags &flags = reliableBuffer.header.flags.value;
+      arqReceiver.prepare(reliableBuffer.header);
+      flags.syn = true;
+      flags.rst = reset;
+      flags.ack = acknowledge; // a syn-ack completes the handshake, so its ackNum is not needed
+      flags.ext = ReliableBuffer::kExtendedHeaderSupported; // a syn offers the extended header, and a syn-ack accepts it
+      reliableBuffer.header.seqNum = arqSender.base(); // the peer's receiver will expect this sequence number next
+      const uint8_t payload[] = {ReliableBuffer::kPayloadSizeLimit}; // the largest fragment we can receive
+      sendControl(reliableBuffer, ByteBufferView(payload, sizeof(payload)));
+      if (!acknowledge) synchronizeTimer.start(); // retransmit syn until it is acknowledged
+    }
+
+    bool receiveSession(const ReliableBuffer &reliableBuffer) {
+      const ReliableBufferHeader &header = reliableBuffer.header;
+      const ReliableBufferFlags &flags = header.flags.value;
+      if (flags.fin) {
+        arqSender.reset(); // the peer has discarded its receiver state, so anything in flight is lost
+        session = Session::closed;
+        resetPending = false;
+        synchronizeTimer.resetAndStop();
+        return true;
+      }
+      if (!flags.syn) return false;
+      if (flags.ack && session != Session::synchronizing) return true; // duplicate syn-ack would rewind nextExpected
+
+      if (flags.rst) arqSender.reset();
+      arqReceiver.synchronize(header.seqNum);
+      reassembly.clear(); // any partial payload is stale
+      reassemblyOverflowed = false;
+      if (!reliableBuffer.payload().empty()) fragmentSizer.setLimit(reliableBuffer.payload()[0]);
+      peerExtendedHeader = flags.ext;
+      arqSender.setExtended(extendedHeader());
+      arqReceiver.setExtended(extendedHeader());
+      if (!flags.ack) sendSession(resetPending, true); // reply with syn-ack, carrying our own send base and any pending reset
+      else resetPending = false; // the peer has acknowledged our syn, and so the reset it carried
+      if (resetPending) return true; // keep resending the reset until the peer acknowledges it
+      session = Session::established;
+      synchronizeTimer.resetAndStop();
+      arqSender.resend(); // whatever was in flight may have been discarded by the peer's stale receiver
+      sendQueued();
+      return true;
+    }
 };
 
 } } }
\ No newline at end of file
@@ -8,6 +8,11 @@
 // Phyllo
 #include "Phyllo/Types.h"
 #include "Phyllo/Protocol/Transport/ReliableBufferLink.h"
+#include "Phyllo/Protocol/Transport/FECLink.h"
+#include "Phyllo/Protocol/Transport/LinkQuality.h"
+#include "Phyllo/Protocol/Transport/Capabilities.h"
+#include "Phyllo/Protocol/Transport/PortedBufferLink.h"
+#include "Phyllo/Protocol/Transport/ByteStreamLink.h"
 
 // Stacks orchestrate the flow of data through protocol layers
 
@@ -70,7 +75,7 @@ class StreamMediumStack {
 
     OptionalReceive receive() {
       while (true) {
-        while (buffered.hasRead() && !chunk.hasRead()) chunk.receive(buffered.read());
+        while (buffered.hasRead() && !chunk.hasRead()) buffered.consume(chunk.receive(buffered.peekAll()));
         fillStreamBuffer();
         if (chunk.hasRead() || buffered.full() || !stream.hasRead()) break; // nothing left to do this cycle
       }
@@ -85,6 +90,12 @@ class StreamMediumStack {
       return top.send(payload, type);
     }
 
+    // StreamMediumStack interface
+
+    void flush() { // blocks until all queued bytes have been handed to the stream
+      stream.flush();
+    }
+
   protected:
     using IntermediateToSendDelegate = etl::delegate<bool(const ByteBufferView &, DataUnitTypeCode)>;
     IntermediateToSendDelegate intermediateToSender;
@@ -125,29 +136,38 @@ class MinimalLogicalStack {
     using SendDelegate = TopLink::SendDelegate;
     using ToSend = BottomLink::ToSend; // The type of data passed down to below
     using ToSendDelegate = BottomLink::ToSendDelegate;
+    using LayerDelegate = etl::delegate<bool(const Datagram &)>; // returns whether the datagram was consumed
 
     DatagramLink datagram;
+    CapabilitiesExchange capabilities;
 
     TopLink &top;
     BottomLink &bottom;
     SendDelegate sender;
 
     MinimalLogicalStack(const ToSendDelegate &toSender) :
-      datagram(toSender),
+      datagram(toSender), capabilities(datagram),
       top(datagram), bottom(datagram),
       sender(SendDelegate::create<TopLink, &TopLink::send>(top)) {}
 
     void setup() {
       datagram.setup();
+      capabilities.setup();
     }
     void update() {
       datagram.update();
+      capabilities.update();
     }
 
     // Event loop interface
 
     OptionalReceive receive(const ByteBufferView &buffer) {
-      return datagram.receive(buffer);
+      auto received = datagram.receive(buffer);
+      if (!received) return received;
+      if (capabilities.receive(*received)) return OptionalReceive();
+      if (layerHandler.is_valid() && layerHandler(*received)) return OptionalReceive();
+
+      return received;
     }
 
     // ByteBufferLink interface
@@ -155,6 +175,15 @@ class MinimalLogicalStack {
     bool send(const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Bytes::Buffer) {
       return top.send(payload, type);
     }
+
+    // MinimalLogicalStack interface
+
+    void setLayerHandler(const LayerDelegate &handler) { // e.g. for link management exchanges defined outside the transport layers
+      layerHandler = handler;
+    }
+
+  protected:
+    LayerDelegate layerHandler;
 };
 
 class ReducedLogicalStack {
@@ -227,12 +256,16 @@ class StandardLogicalStack {
 
     TopLink &top;
     BottomLink &bottom;
-    SendDelegate sender;
+    SendDelegate sender; // sends reliably
+    SendDelegate unreliableSender; // sends without retransmission, e.g. for high-rate telemetry
+    SendDelegate urgentSender; // sends reliably ahead of queued bulk data, e.g. for control messages
 
     StandardLogicalStack(const ToSendDelegate &toSender) :
       reduced(toSender), reliable(reduced.sender),
       top(reliable), bottom(reduced.bottom),
-      sender(SendDelegate::create<TopLink, &TopLink::send>(top)) {}
+      sender(SendDelegate::create<TopLink, &TopLink::sendReliable>(top)),
+      unreliableSender(SendDelegate::create<TopLink, &TopLink::sendUnreliable>(top)),
+      urgentSender(SendDelegate::create<TopLink, &TopLink::sendUrgent>(top)) {}
 
     void setup() {
       reduced.setup();
@@ -259,9 +292,379 @@ class StandardLogicalStack {
 
     // ByteBufferLink interface
 
+    bool send(
+      const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Bytes::Buffer, bool reliable = true
+    ) {
+      return top.send(payload, type, reliable);
+    }
+};
+
+class CorrectedLogicalStack { // Reduced logical stack with forward error correction, to avoid the need for retransmission
+  public:
+    using TopLink = ReducedLogicalStack::TopLink;
+    using BottomLink = FECLink;
+
+    using ToReceive = BottomLink::ToReceive; // The type of data passed up from below
+    using Receive = TopLink::Receive; // The type of data passed up to above
+    using OptionalReceive = TopLink::OptionalReceive;
+    using Send = TopLink::Send; // The type of data passed down from above
+    using SendDelegate = TopLink::SendDelegate;
+    using ToSend = BottomLink::ToSend; // The type of data passed down to below
+    using ToSendDelegate = BottomLink::ToSendDelegate;
+
+    static const size_t kPayloadSizeLimit = ValidatedDatagram::kPayloadSizeLimit - FECLink::kOverheadSize; // datagrams must leave room for the parity bytes
+
+    FECLink fec;
+    ReducedLogicalStack reduced;
+
+    TopLink &top;
+    BottomLink &bottom;
+    SendDelegate sender;
+
+    CorrectedLogicalStack(const ToSendDelegate &toSender) :
+      fec(toSender), reduced(intermediateToSender),
+      top(reduced.top), bottom(fec),
+      sender(SendDelegate::create<TopLink, &TopLink::send>(top)) {
+        intermediateToSender = IntermediateToSendDelegate::create<FECLink, &FECLink::send>(fec);
+        reduced.minimal.capabilities.setLinkOverhead(FECLink::kOverheadSize); // so oversized sends fail here instead of in FECLink
+      }
+
+    void setup() {
+      fec.setup();
+      reduced.setup();
+    }
+    void update() {
+      fec.update();
+      reduced.update();
+    }
+
+    // Event loop interface
+
+    OptionalReceive receive(const ByteBufferView &buffer) {
+      auto fecReceived = fec.receive(buffer);
+      if (!fecReceived) return OptionalReceive();
+
+      return reduced.receive(getPayload(*fecReceived));
+    }
+
+    // ByteBufferLink interface
+
     bool send(const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Bytes::Buffer) {
       return top.send(payload, type);
     }
+
+  protected:
+    using IntermediateToSendDelegate = ReducedLogicalStack::ToSendDelegate;
+    IntermediateToSendDelegate intermediateToSender;
+};
+
+class AdaptiveLogicalStack { // Logical stack which switches among the minimal, reduced, and standard services by agreement with the peer
+  public:
+    enum class Mode : uint8_t {
+      minimal = 0, // datagrams without validation or retransmission
+      reduced = 1, // validated datagrams
+      standard = 2 // validated datagrams carrying reliable buffers
+    };
+
+    using TopLink = AdaptiveLogicalStack;
+    using BottomLink = MinimalLogicalStack::BottomLink;
+
+    using ToReceive = BottomLink::ToReceive; // The type of data passed up from below
+    using Receive = Datagram; // The type of data passed up to above; payloads received in any mode are passed up as datagrams
+    using OptionalReceive = MinimalLogicalStack::OptionalReceive;
+    using Send = ByteBufferView; // The type of data passed down from above
+    using SendDelegate = etl::delegate<bool(const Send &, DataUnitTypeCode)>;
+    using ToSend = BottomLink::ToSend; // The type of data passed down to below
+    using ToSendDelegate = BottomLink::ToSendDelegate;
+
+    static const size_t kPayloadSizeLimit = ReliableBuffer::kPayloadSizeLimit; // payloads must fit in every mode
+    static const unsigned long kAdvertiseInterval = 1000; // ms between repeated mode requests, in case one was lost
+
+    StandardLogicalStack standard;
+    LinkQualityMonitor quality;
+
+    TopLink &top;
+    BottomLink &bottom;
+    SendDelegate sender;
+
+    AdaptiveLogicalStack(const ToSendDelegate &toSender) :
+      standard(toSender),
+      top(*this), bottom(standard.bottom),
+      sender(SendDelegate::create<AdaptiveLogicalStack, &AdaptiveLogicalStack::send>(*this)),
+      advertiseTimer(kAdvertiseInterval) {}
+
+    void setup() {
+      standard.setup();
+      quality.setup();
+      advertise();
+    }
+    void update() {
+      standard.reduced.update();
+      if (current == Mode::standard) standard.reliable.update(); // don't pay for acks and heartbeats in other modes
+
+      switch (quality.update()) {
+        case LinkQualityMonitor::Verdict::degraded:
+          request(step(desired, 1));
+          break;
+        case LinkQualityMonitor::Verdict::recovered:
+          request(step(desired, -1));
+          break;
+        default:
+          break;
+      }
+      if (advertiseTimer.timedOut()) advertise();
+    }
+
+    // Event loop interface
+
+    OptionalReceive receive(const ByteBufferView &buffer) {
+      if (current == Mode::standard) standard.reliable.update();
+      auto minimalReceived = standard.reduced.minimal.receive(buffer);
+      if (!minimalReceived) {
+        if (!buffer.empty()) quality.failed(); // inconsistent datagram length
+        return minimalReceived;
+      }
+
+      switch (getPayloadType(*minimalReceived)) {
+        case DataUnitType::Layer::Control:
+          receiveModeRequest(getPayload(*minimalReceived));
+          return OptionalReceive();
+        case DataUnitType::Transport::ValidatedDatagram:
+          return receiveValidated(*minimalReceived);
+        default:
+          quality.received();
+          return minimalReceived;
+      }
+    }
+
+    // ByteBufferLink interface
+
+    bool send(const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Bytes::Buffer) {
+      if (payload.size() > kPayloadSizeLimit) return false;
+
+      switch (current) {
+        case Mode::minimal:
+          if (type == DataUnitType::Layer::Control) return false; // reserved for mode requests
+          return standard.reduced.minimal.send(payload, type);
+        case Mode::reduced:
+          return standard.reduced.send(payload, type);
+        default:
+          return standard.send(payload, type);
+      }
+    }
+
+    // AdaptiveLogicalStack interface
+
+    Mode mode() const { // the mode used for sending, which is the more protective of the modes requested by the two peers
+      return current;
+    }
+
+    Mode desiredMode() const {
+      return desired;
+    }
+
+    Mode peerMode() const {
+      return peerRequested;
+    }
+
+    void setMinimumMode(Mode mode) {
+      // e.g. to force reliable delivery regardless of measured link quality
+      minimum = mode;
+      request(desired);
+    }
+
+  protected:
+    Mode desired = Mode::minimal;
+    Mode minimum = Mode::minimal;
+    Mode peerRequested = Mode::minimal;
+    Mode current = Mode::minimal;
+    Util::TimeoutTimer advertiseTimer;
+
+    static Mode step(Mode mode, int steps) {
+      int stepped = static_cast<int>(mode) + steps;
+      if (stepped < static_cast<int>(Mode::minimal)) return Mode::minimal;
+      if (stepped > static_cast<int>(Mode::standard)) return Mode::standard;
+      return static_cast<Mode>(stepped);
+    }
+
+    static Mode higher(Mode first, Mode second) {
+      return (static_cast<uint8_t>(first) > static_cast<uint8_t>(second)) ? first : second;
+    }
+
+    OptionalReceive receiveValidated(const Datagram &datagram) {
+      OptionalReceive received;
+      auto validatedReceived = standard.reduced.validated.receive(
+        getPayload(datagram), getPayloadType(datagram)
+      );
+      if (!validatedReceived) {
+        quality.failed(); // CRC mismatch
+        return received;
+      }
+
+      quality.received();
+      if (getPayloadType(*validatedReceived) != DataUnitType::Transport::ReliableBuffer) {
+        received->header.type = getPayloadType(*validatedReceived);
+        received.enabled = received->write(getPayload(*validatedReceived));
+        return received;
+      }
+
+      auto reliableReceived = standard.reliable.receive(
+        getPayload(*validatedReceived), getPayloadType(*validatedReceived)
+      );
+      if (!reliableReceived) return received;
+
+      received->header.type = getPayloadType(*reliableReceived);
+      received.enabled = received->write(getPayload(*reliableReceived));
+      return received;
+    }
+
+    void receiveModeRequest(const ByteBufferView &payload) {
+      if (payload.size() != 1 || payload[0] > static_cast<uint8_t>(Mode::standard)) return;
+
+      quality.received(); // periodic mode requests let even a send-only peer judge the link
+      peerRequested = static_cast<Mode>(payload[0]);
+      updateMode();
+    }
+
+    void request(Mode mode) {
+      mode = higher(mode, minimum);
+      if (mode == desired) return;
+
+      desired = mode;
+      advertise();
+      updateMode();
+    }
+
+    void advertise() {
+      // Mode requests are always sent as minimal datagrams, which every mode can receive
+      const uint8_t payload[] = {static_cast<uint8_t>(desired)};
+      standard.reduced.minimal.send(ByteBufferView(payload, sizeof(payload)), DataUnitType::Layer::Control);
+      advertiseTimer.start();
+    }
+
+    void updateMode() {
+      Mode next = higher(desired, peerRequested);
+      if (next == Mode::standard && current != Mode::standard) {
+        standard.reliable.synchronize(); // sequence state is stale after time spent in other modes
+      }
+      current = next;
+    }
+};
+
+// Logical stack decorators add services on top of any logical stack
+
+template<typename LogicalStack>
+const typename LogicalStack::SendDelegate &unreliableSender(LogicalStack &logical) {
+  return logical.sender; // stacks without retransmission are always unreliable
+}
+inline const StandardLogicalStack::SendDelegate &unreliableSender(StandardLogicalStack &logical) {
+  return logical.unreliableSender;
+}
+
+template<typename Logical>
+class PortedLogicalStack { // Logical stack which also carries port-multiplexed channels alongside its regular traffic
+  public:
+    using LogicalStack = Logical;
+    using TopLink = typename LogicalStack::TopLink;
+    using BottomLink = typename LogicalStack::BottomLink;
+
+    using ToReceive = typename BottomLink::ToReceive; // The type of data passed up from below
+    using Receive = typename TopLink::Receive; // The type of data passed up to above
+    using OptionalReceive = typename TopLink::OptionalReceive;
+    using Send = typename TopLink::Send; // The type of data passed down from above
+    using SendDelegate = typename TopLink::SendDelegate;
+    using ToSend = typename BottomLink::ToSend; // The type of data passed down to below
+    using ToSendDelegate = typename BottomLink::ToSendDelegate;
+
+    LogicalStack logical;
+    PortedBufferLink ported;
+
+    TopLink &top;
+    BottomLink &bottom;
+    SendDelegate &sender;
+
+    PortedLogicalStack(const ToSendDelegate &toSender) :
+      logical(toSender), ported(logical.sender, unreliableSender(logical)),
+      top(logical.top), bottom(logical.bottom), sender(logical.sender) {}
+
+    void setup() {
+      logical.setup();
+      ported.setup();
+    }
+    void update() {
+      logical.update();
+      ported.update();
+    }
+
+    // Event loop interface
+
+    OptionalReceive receive(const ByteBufferView &buffer) {
+      // PortedBuffers are queued on their ports, to be read with ported.read(); everything else passes through
+      auto logicalReceived = logical.receive(buffer);
+      if (!logicalReceived) return logicalReceived;
+      if (ported.receive(getPayload(*logicalReceived), getPayloadType(*logicalReceived))) return OptionalReceive();
+
+      return logicalReceived;
+    }
+
+    // ByteBufferLink interface
+
+    bool send(const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Bytes::Buffer) {
+      return logical.send(payload, type);
+    }
+};
+
+template<typename Logical>
+class StreamingLogicalStack { // Logical stack which also carries a byte stream alongside its regular traffic
+  public:
+    using LogicalStack = Logical;
+    using TopLink = typename LogicalStack::TopLink;
+    using BottomLink = typename LogicalStack::BottomLink;
+
+    using ToReceive = typename BottomLink::ToReceive; // The type of data passed up from below
+    using Receive = typename TopLink::Receive; // The type of data passed up to above
+    using OptionalReceive = typename TopLink::OptionalReceive;
+    using Send = typename TopLink::Send; // The type of data passed down from above
+    using SendDelegate = typename TopLink::SendDelegate;
+    using ToSend = typename BottomLink::ToSend; // The type of data passed down to below
+    using ToSendDelegate = typename BottomLink::ToSendDelegate;
+
+    LogicalStack logical;
+    ByteStreamLink stream;
+
+    TopLink &top;
+    BottomLink &bottom;
+    SendDelegate &sender;
+
+    StreamingLogicalStack(const ToSendDelegate &toSender) :
+      logical(toSender), stream(logical.sender),
+      top(logical.top), bottom(logical.bottom), sender(logical.sender) {}
+
+    void setup() {
+      logical.setup();
+      stream.setup();
+    }
+    void update() {
+      logical.update();
+      stream.update();
+    }
+
+    // Event loop interface
+
+    OptionalReceive receive(const ByteBufferView &buffer) {
+      // Stream segments are buffered for stream.read(); everything else passes through
+      auto logicalReceived = logical.receive(buffer);
+      if (!logicalReceived) return logicalReceived;
+      if (stream.receive(getPayload(*logicalReceived), getPayloadType(*logicalReceived))) return OptionalReceive();
+
+      return logicalReceived;
+    }
+
+    // ByteBufferLink interface
+
+    bool send(const ByteBufferView &payload, DataUnitTypeCode type = DataUnitType::Bytes::Buffer) {
+      return logical.send(payload, type);
+    }
 };
 
 template<typename MediumStack, typename LogicalStack>
@@ -10,6 +10,15 @@
 
 // Frame layer handles data framing
 
+// The chunk size limit is defined here, since the send queue must hold a whole chunk
+#ifndef PHYLLO_TRANSPORT_CHUNK_SIZE_LIMIT
+#define PHYLLO_TRANSPORT_CHUNK_SIZE_LIMIT 255  // For USB, 255 ensures that the starting delimiter won't be translated as its own USB packet, for higher performance on max-length chunks
+#endif
+
+#ifndef PHYLLO_TRANSPORT_STREAM_SEND_QUEUE_SIZE
+#define PHYLLO_TRANSPORT_STREAM_SEND_QUEUE_SIZE 0 // bytes held while the stream's TX buffer is full, at least PHYLLO_TRANSPORT_CHUNK_SIZE_LIMIT + 1; 0 makes writes block. Only for streams which implement availableForWrite, since it returns 0 by default!
+#endif
+
 namespace Phyllo { namespace Protocol { namespace Transport {
 
 template<typename Stream>
@@ -26,6 +35,11 @@ class StreamLink {
     using ToSendDelegate = void;
 
     static const long kTimeout = 0;
+    static const size_t kSendQueueSize = PHYLLO_TRANSPORT_STREAM_SEND_QUEUE_SIZE;
+    static_assert(
+      kSendQueueSize == 0 || kSendQueueSize >= PHYLLO_TRANSPORT_CHUNK_SIZE_LIMIT + 1,
+      "Stream send queue must be disabled or hold a whole chunk with its markers!"
+    );
 
     StreamLink(Stream &stream) : stream(&stream) {}
     StreamLink(Stream *stream) : stream(stream) {}
@@ -35,7 +49,9 @@ class StreamLink {
     void setup() {
       setTimeout();
     };
-    void update() {}
+    void update() {
+      drain();
+    }
 
     // Peek interface
 
@@ -58,13 +74,91 @@ class StreamLink {
 
     // ByteBufferLink interface
 
-    bool send(const ByteBufferView &buffer, uint8_t type = DataUnitType::Bytes::Stream);
-    bool send(const uint8_t *buffer, size_t size, uint8_t type = DataUnitType::Bytes::Stream);
-    bool send(uint8_t byte, uint8_t type = DataUnitType::Bytes::Stream);
+    bool send(const ByteBufferView &buffer, uint8_t type = DataUnitType::Bytes::Stream) {
+      return send(buffer.data(), buffer.size(), type);
+    }
+    bool send(const uint8_t *buffer, size_t size, uint8_t type = DataUnitType::Bytes::Stream) {
+      // Buffers are sent whole or not at all, so a failed send means "would block" and can simply be retried later
+      if (buffer == nullptr || !size) return false;
+      if (!kSendQueueSize) return write(buffer, size) == size; // blocks until the stream accepts everything
+
+      drain();
+      size_t direct = sendQueued() ? 0 : writable(); // bytes must not overtake queued bytes
+      if (direct > size) direct = size;
+      if (size - direct > sendQueueAvailable()) {
+        ++blockedSends;
+        return false;
+      }
+
+      if (direct) direct = write(buffer, direct);
+      enqueue(buffer + direct, size - direct);
+      return true;
+    }
+    bool send(uint8_t byte, uint8_t type = DataUnitType::Bytes::Stream) {
+      return send(&byte, 1, type);
+    }
+
+    // Write interface
+
+    size_t availableForWrite() { // the largest buffer which can be sent now without blocking
+      if (!kSendQueueSize) return writable();
+
+      return (sendQueued() ? 0 : writable()) + sendQueueAvailable();
+    }
+
+    size_t sendQueued() const {
+      return sendQueue.size() - sendCursor;
+    }
+
+    void flush() { // blocks until everything queued has been handed to the stream
+      if (sendQueued()) write(sendQueue.data() + sendCursor, sendQueued());
+      sendQueue.clear();
+      sendCursor = 0;
+    }
+
+    unsigned long blockedCount() const { // sends refused because they would have blocked
+      return blockedSends;
+    }
 
   protected:
+    FixedByteBuffer<kSendQueueSize ? kSendQueueSize : 1> sendQueue;
+    size_t sendCursor = 0;
+    unsigned long blockedSends = 0;
+
     size_t read(Receive *buffer, size_t maxLength);
     void setTimeout();
+    size_t writable(); // bytes the stream can accept without blocking
+    size_t write(const uint8_t *buffer, size_t size);
+
+    size_t sendQueueAvailable() const {
+      return kSendQueueSize - sendQueued();
+    }
+
+    void enqueue(const uint8_t *buffer, size_t size) {
+      if (!size) return;
+
+      if (sendQueue.size() + size > kSendQueueSize) { // move the queued bytes to the front to make room
+        size_t queued = sendQueued();
+        memmove(sendQueue.data(), sendQueue.data() + sendCursor, queued);
+        sendQueue.resize(queued);
+        sendCursor = 0;
+      }
+      size_t end = sendQueue.size();
+      sendQueue.resize(end + size);
+      memcpy(sendQueue.data() + end, buffer, size);
+    }
+
+    void drain() {
+      if (!sendQueued()) return;
+
+      size_t size = writable();
+      if (size > sendQueued()) size = sendQueued();
+      if (size) sendCursor += write(sendQueue.data() + sendCursor, size);
+      if (sendQueued()) return;
+
+      sendQueue.clear();
+      sendCursor = 0;
+    }
 };
 
 // Buffered stream reading for more efficient serial reading over USB connections
@@ -129,6 +223,20 @@ class BufferedStreamLink {
       return buffer;
     }
 
+    // Span interface
+
+    ByteBufferView peekAll() const {
+      return ByteBufferView(readBuffer.begin() + cursor, readBuffer.end());
+    }
+
+    void consume(size_t bytesConsumed) {
+      cursor += min(bytesConsumed, readBuffer.size() - cursor);
+      if (cursor < readBuffer.size()) return;
+
+      cursor = 0;
+      readBuffer.clear();
+    }
+
     // ByteBufferLink interface
 
     bool receive(uint8_t streamByte) {
@@ -9,6 +9,8 @@
 #include "Phyllo/Protocol/Transport/Stacks.h"
 #include "Phyllo/Protocol/Stacks.h"
 #include "Phyllo/IO/SerialLink.h"
+#include "Phyllo/IO/BaudRate.h"
+#include "Phyllo/IO/ByteStream.h"
 
 // Standard stacks provide end-to-end communication functionality
 
@@ -52,7 +54,9 @@ class SerialCommunicationStack {
       stream(stream), medium(stream), logical(medium.sender),
       transport(medium, logical), application(transport.sender),
       protocol(transport, application),
-      top(protocol.top), bottom(protocol.bottom), sender(protocol.sender) {}
+      top(protocol.top), bottom(protocol.bottom), sender(protocol.sender) {
+        setUrgentSender(logical, application, 0);
+      }
 
     // Event loop interface
 
@@ -68,9 +72,24 @@ class SerialCommunicationStack {
     OptionalReceive receive() {
       return protocol.receive();
     }
+    template<typename Handler>
+    bool receive(Handler &handler) { // passes the received document to the handler without copying it
+      return protocol.receive(handler);
+    }
 
     // No send methods because the calling interface can vary; instead,
     // call protocol.send() or top.send() (they are the same method)!
+
+  protected:
+    // Wires the logical stack's urgent sender into the application stack, where both stacks support it
+
+    template<typename Logical, typename Application>
+    static auto setUrgentSender(Logical &logical, Application &application, int)
+      -> decltype(application.setUrgentToSendDelegate(logical.urgentSender), void()) {
+      application.setUrgentToSendDelegate(logical.urgentSender);
+    }
+    template<typename Logical, typename Application>
+    static void setUrgentSender(Logical &logical, Application &application, long) {}
 };
 
 template<typename CommunicationStack, typename ProtocolEventHandler>
@@ -120,6 +139,9 @@ class FullStack {
       event.receive(*communicationReceived);
       return communicationReceived;
     }
+    bool dispatch() { // passes the received document to the event handler without copying it
+      return communication.receive(event);
+    }
 
     // No send methods because the calling interface can vary; instead,
     // call communication.send() or top.send() (they are the same method)!
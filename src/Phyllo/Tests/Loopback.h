@@ -135,13 +135,13 @@ void loopEchoDirect(Stack &stack) { // useful to test receiving correctness of c
 }
 
 Protocol::Presentation::MsgPack::Document copyFlatDocument(
-  const Protocol::Presentation::MsgPack::Document &inDocument
+  const Protocol::Presentation::MsgPack::DocumentView &inDocument
 ) { // warning: only valid for primitives, and arrays and maps without nesting!
   using namespace Protocol::Presentation::MsgPack;
 
   Document document;
   document.header.schema = inDocument.header.schema;
-  Document::Reader &reader = inDocument.reader;
+  DocumentView::Reader &reader = inDocument.reader;
   Document::Writer &writer = document.writer;
   reader.start();
   writer.start();
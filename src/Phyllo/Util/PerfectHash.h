@@ -0,0 +1,135 @@
+#pragma once
+
+// Standard libraries
+#include <stdint.h>
+
+// Third-party libraries
+
+// Phyllo
+#include "Phyllo/Types.h"
+
+// Perfect hashing maps a set of names known at compile time to distinct slots of a small table, so that a name
+// can be looked up with one hash and one comparison. Seeds and tables are found by C++11 constexpr functions.
+
+namespace Phyllo { namespace Util {
+
+// Index sequences for expanding tables from parameter packs (std::index_sequence needs C++14)
+
+template<size_t... Indices>
+struct IndexSequence {};
+
+template<size_t Size, size_t... Indices>
+struct IndexSequenceMaker : IndexSequenceMaker<Size - 1, Size - 1, Indices...> {};
+template<size_t... Indices>
+struct IndexSequenceMaker<0, Indices...> {
+  using Type = IndexSequence<Indices...>;
+};
+
+template<size_t Size>
+using MakeIndexSequence = typename IndexSequenceMaker<Size>::Type;
+
+// Hashing
+
+using PerfectHashCode = uint32_t;
+const PerfectHashCode kPerfectHashBasis = 2166136261UL; // FNV-1a offset basis, perturbed by the seed
+const PerfectHashCode kPerfectHashPrime = 16777619UL; // FNV-1a prime
+const PerfectHashCode kPerfectHashNoSeed = 0xffffffffUL;
+const PerfectHashCode kPerfectHashSeeds = 1024; // seeds to try for each table size before trying a larger table
+const size_t kPerfectHashMaxTableSize = 64; // slot sets are tracked in a 64-bit mask during the search
+const uint8_t kPerfectHashNoIndex = 0xff;
+
+constexpr PerfectHashCode perfectHashStep(PerfectHashCode hash, uint8_t byte) {
+  return (hash ^ byte) * kPerfectHashPrime;
+}
+
+constexpr PerfectHashCode perfectHashFinish(PerfectHashCode hash) { // fold the well-mixed high bits into the slot bits
+  return hash ^ (hash >> 16);
+}
+
+constexpr PerfectHashCode perfectHashFrom(PerfectHashCode hash, const char *name) {
+  return *name ? perfectHashFrom(perfectHashStep(hash, static_cast<uint8_t>(*name)), name + 1) : perfectHashFinish(hash);
+}
+
+constexpr PerfectHashCode perfectHash(const char *name, PerfectHashCode seed) {
+  return perfectHashFrom(kPerfectHashBasis ^ seed, name);
+}
+
+inline PerfectHashCode perfectHash(const ByteBufferView &name, PerfectHashCode seed) { // matches the constexpr hash
+  PerfectHashCode hash = kPerfectHashBasis ^ seed;
+  for (uint8_t byte : name) hash = perfectHashStep(hash, byte);
+  return perfectHashFinish(hash);
+}
+
+constexpr bool perfectHashNamesEqual(const char *name, const char *other) {
+  return (*name == *other) && (*name == '\0' || perfectHashNamesEqual(name + 1, other + 1));
+}
+
+inline bool perfectHashNameMatches(const ByteBufferView &name, const char *expected) {
+  for (uint8_t byte : name) {
+    if (*expected == '\0' || static_cast<uint8_t>(*expected) != byte) return false;
+    ++expected;
+  }
+  return *expected == '\0';
+}
+
+// Searches for seeds and table sizes; the search is split in halves so that recursion depth grows logarithmically
+
+constexpr bool perfectHashDistinct(PerfectHashCode seed, size_t tableSize, uint64_t used) {
+  return true;
+}
+template<typename... Names>
+constexpr bool perfectHashDistinct(
+  PerfectHashCode seed, size_t tableSize, uint64_t used, const char *name, Names... names
+) {
+  return !(used & (uint64_t(1) << (perfectHash(name, seed) % tableSize)))
+    && perfectHashDistinct(seed, tableSize, used | (uint64_t(1) << (perfectHash(name, seed) % tableSize)), names...);
+}
+
+template<typename... Names>
+constexpr PerfectHashCode perfectHashSeed(PerfectHashCode begin, PerfectHashCode end, size_t tableSize, Names... names);
+template<typename... Names>
+constexpr PerfectHashCode perfectHashSeedOr(
+  PerfectHashCode found, PerfectHashCode begin, PerfectHashCode end, size_t tableSize, Names... names
+) {
+  return (found != kPerfectHashNoSeed) ? found : perfectHashSeed(begin, end, tableSize, names...);
+}
+template<typename... Names>
+constexpr PerfectHashCode perfectHashSeed(PerfectHashCode begin, PerfectHashCode end, size_t tableSize, Names... names) {
+  // Returns the first seed in [begin, end) which gives every name its own slot
+  return (end - begin == 1)
+    ? (perfectHashDistinct(begin, tableSize, 0, names...) ? begin : kPerfectHashNoSeed)
+    : perfectHashSeedOr(
+      perfectHashSeed(begin, begin + (end - begin) / 2, tableSize, names...),
+      begin + (end - begin) / 2, end, tableSize, names...
+    );
+}
+
+template<typename... Names>
+constexpr size_t perfectHashTableSize(size_t tableSize, Names... names) {
+  // Returns the smallest table size, starting from the number of names, for which a seed exists
+  return (tableSize >= kPerfectHashMaxTableSize || perfectHashSeed(0, kPerfectHashSeeds, tableSize, names...) != kPerfectHashNoSeed)
+    ? tableSize : perfectHashTableSize(tableSize + 1, names...);
+}
+
+constexpr uint8_t perfectHashIndex(PerfectHashCode seed, size_t tableSize, size_t slot, uint8_t index) {
+  return kPerfectHashNoIndex;
+}
+template<typename... Names>
+constexpr uint8_t perfectHashIndex(
+  PerfectHashCode seed, size_t tableSize, size_t slot, uint8_t index, const char *name, Names... names
+) {
+  // Returns the index of the name which hashes to the slot
+  return (perfectHash(name, seed) % tableSize == slot) ? index : perfectHashIndex(seed, tableSize, slot, index + 1, names...);
+}
+
+template<size_t TableSize>
+struct PerfectHashTable {
+  uint8_t indices[TableSize]; // index of the name in each slot, or kPerfectHashNoIndex
+};
+
+template<size_t TableSize, size_t... Slots, typename... Names>
+constexpr PerfectHashTable<TableSize> perfectHashTable(PerfectHashCode seed, IndexSequence<Slots...>, Names... names) {
+  return PerfectHashTable<TableSize>{{perfectHashIndex(seed, TableSize, Slots, 0, names...)...}};
+}
+
+} }
\ No newline at end of file
@@ -0,0 +1,232 @@
+#pragma once
+
+// Standard libraries
+#include <stdint.h>
+
+// Third-party libraries
+
+// Phyllo
+
+// Reed-Solomon codes are used to correct corrupted bytes in a buffer without retransmission
+
+#define PHYLLO_FEC_TABLE_RAM 0
+#define PHYLLO_FEC_TABLE_PROGMEM 1
+
+#ifndef PHYLLO_FEC
+#define PHYLLO_FEC PHYLLO_FEC_TABLE_PROGMEM
+#endif
+
+namespace Phyllo { namespace Util {
+
+// Arithmetic in GF(2^8) with the primitive polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11D) and generator 0x02
+
+static const size_t kGFOrder = 255; // number of nonzero field elements
+
+// Lookup tables generated by repeated multiplication by the generator; kGFLog[0] is undefined
+#if PHYLLO_FEC == PHYLLO_FEC_TABLE_RAM
+const uint8_t kGFExp[kGFOrder] = {
+#elif PHYLLO_FEC == PHYLLO_FEC_TABLE_PROGMEM
+const uint8_t kGFExp[kGFOrder] PROGMEM = {
+#endif
+  0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26,
+  0x4C, 0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0,
+  0x9D, 0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23,
+  0x46, 0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1,
+  0x5F, 0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0,
+  0xFD, 0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2,
+  0xD9, 0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE,
+  0x81, 0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC,
+  0x85, 0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54,
+  0xA8, 0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73,
+  0xE6, 0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF,
+  0xE3, 0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41,
+  0x82, 0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6,
+  0x51, 0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09,
+  0x12, 0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16,
+  0x2C, 0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E
+};
+#if PHYLLO_FEC == PHYLLO_FEC_TABLE_RAM
+const uint8_t kGFLog[kGFOrder + 1] = {
+#elif PHYLLO_FEC == PHYLLO_FEC_TABLE_PROGMEM
+const uint8_t kGFLog[kGFOrder + 1] PROGMEM = {
+#endif
+  0x00, 0x00, 0x01, 0x19, 0x02, 0x32, 0x1A, 0xC6, 0x03, 0xDF, 0x33, 0xEE, 0x1B, 0x68, 0xC7, 0x4B,
+  0x04, 0x64, 0xE0, 0x0E, 0x34, 0x8D, 0xEF, 0x81, 0x1C, 0xC1, 0x69, 0xF8, 0xC8, 0x08, 0x4C, 0x71,
+  0x05, 0x8A, 0x65, 0x2F, 0xE1, 0x24, 0x0F, 0x21, 0x35, 0x93, 0x8E, 0xDA, 0xF0, 0x12, 0x82, 0x45,
+  0x1D, 0xB5, 0xC2, 0x7D, 0x6A, 0x27, 0xF9, 0xB9, 0xC9, 0x9A, 0x09, 0x78, 0x4D, 0xE4, 0x72, 0xA6,
+  0x06, 0xBF, 0x8B, 0x62, 0x66, 0xDD, 0x30, 0xFD, 0xE2, 0x98, 0x25, 0xB3, 0x10, 0x91, 0x22, 0x88,
+  0x36, 0xD0, 0x94, 0xCE, 0x8F, 0x96, 0xDB, 0xBD, 0xF1, 0xD2, 0x13, 0x5C, 0x83, 0x38, 0x46, 0x40,
+  0x1E, 0x42, 0xB6, 0xA3, 0xC3, 0x48, 0x7E, 0x6E, 0x6B, 0x3A, 0x28, 0x54, 0xFA, 0x85, 0xBA, 0x3D,
+  0xCA, 0x5E, 0x9B, 0x9F, 0x0A, 0x15, 0x79, 0x2B, 0x4E, 0xD4, 0xE5, 0xAC, 0x73, 0xF3, 0xA7, 0x57,
+  0x07, 0x70, 0xC0, 0xF7, 0x8C, 0x80, 0x63, 0x0D, 0x67, 0x4A, 0xDE, 0xED, 0x31, 0xC5, 0xFE, 0x18,
+  0xE3, 0xA5, 0x99, 0x77, 0x26, 0xB8, 0xB4, 0x7C, 0x11, 0x44, 0x92, 0xD9, 0x23, 0x20, 0x89, 0x2E,
+  0x37, 0x3F, 0xD1, 0x5B, 0x95, 0xBC, 0xCF, 0xCD, 0x90, 0x87, 0x97, 0xB2, 0xDC, 0xFC, 0xBE, 0x61,
+  0xF2, 0x56, 0xD3, 0xAB, 0x14, 0x2A, 0x5D, 0x9E, 0x84, 0x3C, 0x39, 0x53, 0x47, 0x6D, 0x41, 0xA2,
+  0x1F, 0x2D, 0x43, 0xD8, 0xB7, 0x7B, 0xA4, 0x76, 0xC4, 0x17, 0x49, 0xEC, 0x7F, 0x0C, 0x6F, 0xF6,
+  0x6C, 0xA1, 0x3B, 0x52, 0x29, 0x9D, 0x55, 0xAA, 0xFB, 0x60, 0x86, 0xB1, 0xBB, 0xCC, 0x3E, 0x5A,
+  0xCB, 0x59, 0x5F, 0xB0, 0x9C, 0xA9, 0xA0, 0x51, 0x0B, 0xF5, 0x16, 0xEB, 0x7A, 0x75, 0x2C, 0xD7,
+  0x4F, 0xAE, 0xD5, 0xE9, 0xE6, 0xE7, 0xAD, 0xE8, 0x74, 0xD6, 0xF4, 0xEA, 0xA8, 0x50, 0x58, 0xAF
+};
+
+uint8_t gfExp(unsigned int power) {
+  #if PHYLLO_FEC == PHYLLO_FEC_TABLE_RAM
+  return kGFExp[power % kGFOrder];
+  #elif PHYLLO_FEC == PHYLLO_FEC_TABLE_PROGMEM
+  return pgm_read_byte_near(kGFExp + power % kGFOrder);
+  #endif
+}
+
+uint8_t gfLog(uint8_t value) { // Warning: the logarithm of 0 is undefined!
+  #if PHYLLO_FEC == PHYLLO_FEC_TABLE_RAM
+  return kGFLog[value];
+  #elif PHYLLO_FEC == PHYLLO_FEC_TABLE_PROGMEM
+  return pgm_read_byte_near(kGFLog + value);
+  #endif
+}
+
+uint8_t gfMultiply(uint8_t a, uint8_t b) {
+  if (a == 0 || b == 0) return 0;
+
+  return gfExp(gfLog(a) + gfLog(b));
+}
+
+uint8_t gfDivide(uint8_t a, uint8_t b) { // Warning: division by 0 is undefined!
+  if (a == 0) return 0;
+
+  return gfExp(gfLog(a) + kGFOrder - gfLog(b));
+}
+
+uint8_t gfEvaluate(const uint8_t polynomial[], size_t length, uint8_t x) {
+  // Evaluate a polynomial whose coefficients are ordered from lowest degree to highest degree
+  uint8_t result = 0;
+  for (size_t i = length; i > 0; --i) result = gfMultiply(result, x) ^ polynomial[i - 1];
+  return result;
+}
+
+// Systematic Reed-Solomon code with ParitySize parity bytes, shortened to the length of each buffer.
+// Codewords consist of the message followed by its parity bytes, and up to ParitySize / 2 corrupted
+// bytes anywhere in the codeword can be corrected.
+
+template<size_t ParitySize>
+class ReedSolomon {
+  public:
+    static const size_t kParitySize = ParitySize;
+    static const size_t kCorrectableSize = ParitySize / 2;
+    static const size_t kCodewordSizeLimit = kGFOrder;
+    static_assert(ParitySize >= 2 && ParitySize % 2 == 0, "Reed-Solomon parity size must be a positive even number!");
+    static_assert(ParitySize < kCodewordSizeLimit, "Reed-Solomon parity size must be less than the codeword size limit!");
+
+    ReedSolomon() {
+      // Generator polynomial (x - a^0)(x - a^1)...(x - a^(ParitySize - 1)), ordered from highest degree to lowest degree
+      generator[0] = 1;
+      for (size_t i = 1; i <= kParitySize; ++i) generator[i] = 0;
+      for (size_t root = 0; root < kParitySize; ++root) {
+        uint8_t factor = gfExp(root);
+        for (size_t i = root + 1; i > 0; --i) generator[i] ^= gfMultiply(generator[i - 1], factor);
+      }
+    }
+
+    void encode(const uint8_t message[], size_t length, uint8_t parity[]) const {
+      // Compute the remainder of message * x^ParitySize divided by the generator polynomial
+      for (size_t i = 0; i < kParitySize; ++i) parity[i] = 0;
+      for (size_t i = 0; i < length; ++i) {
+        uint8_t feedback = message[i] ^ parity[0];
+        for (size_t j = 0; j + 1 < kParitySize; ++j) {
+          parity[j] = parity[j + 1] ^ gfMultiply(feedback, generator[j + 1]);
+        }
+        parity[kParitySize - 1] = gfMultiply(feedback, generator[kParitySize]);
+      }
+    }
+
+    int decode(uint8_t codeword[], size_t length) const {
+      // Correct the codeword in place, and return the number of corrected bytes, or -1 if it can't be corrected
+      if (length <= kParitySize || length > kCodewordSizeLimit) return -1;
+
+      uint8_t syndromes[kParitySize];
+      if (!computeSyndromes(codeword, length, syndromes)) return 0;
+
+      uint8_t locator[kParitySize + 1];
+      size_t errors = computeLocator(syndromes, locator);
+      if (errors > kCorrectableSize) return -1;
+
+      uint8_t evaluator[kParitySize];
+      computeEvaluator(syndromes, locator, evaluator);
+
+      // Chien search for error positions, with Forney's algorithm for error values
+      size_t corrected = 0;
+      for (size_t position = 0; position < length; ++position) {
+        unsigned int power = length - 1 - position;
+        uint8_t inverse = gfExp(kGFOrder - power % kGFOrder);
+        if (gfEvaluate(locator, errors + 1, inverse) != 0) continue;
+
+        uint8_t derivative = 0; // formal derivative of the locator, evaluated at the inverse
+        for (size_t i = 1; i <= errors; i += 2) derivative ^= gfMultiply(locator[i], gfExp((i - 1) * gfLog(inverse)));
+        if (derivative == 0) return -1;
+
+        uint8_t magnitude = gfMultiply(gfExp(power), gfEvaluate(evaluator, kParitySize, inverse));
+        codeword[position] ^= gfDivide(magnitude, derivative);
+        ++corrected;
+      }
+      if (corrected != errors) return -1; // the locator's roots don't all lie within the codeword
+
+      return corrected;
+    }
+
+  protected:
+    uint8_t generator[kParitySize + 1];
+
+    bool computeSyndromes(const uint8_t codeword[], size_t length, uint8_t syndromes[]) const {
+      // Evaluate the codeword at each root of the generator polynomial; return whether any are nonzero
+      bool corrupted = false;
+      for (size_t root = 0; root < kParitySize; ++root) {
+        uint8_t x = gfExp(root);
+        uint8_t syndrome = 0;
+        for (size_t i = 0; i < length; ++i) syndrome = gfMultiply(syndrome, x) ^ codeword[i];
+        syndromes[root] = syndrome;
+        corrupted = corrupted || syndrome;
+      }
+      return corrupted;
+    }
+
+    size_t computeLocator(const uint8_t syndromes[], uint8_t locator[]) const {
+      // Berlekamp-Massey algorithm; the locator is ordered from lowest degree to highest degree
+      uint8_t previous[kParitySize + 1];
+      uint8_t scratch[kParitySize + 1];
+      for (size_t i = 0; i <= kParitySize; ++i) locator[i] = previous[i] = 0;
+      locator[0] = previous[0] = 1;
+      size_t errors = 0;
+      size_t shift = 1;
+      uint8_t previousDiscrepancy = 1;
+      for (size_t n = 0; n < kParitySize; ++n) {
+        uint8_t discrepancy = syndromes[n];
+        for (size_t i = 1; i <= errors; ++i) discrepancy ^= gfMultiply(locator[i], syndromes[n - i]);
+        if (discrepancy == 0) {
+          ++shift;
+          continue;
+        }
+
+        uint8_t scale = gfDivide(discrepancy, previousDiscrepancy);
+        for (size_t i = 0; i <= kParitySize; ++i) scratch[i] = locator[i];
+        for (size_t i = 0; i + shift <= kParitySize; ++i) locator[i + shift] ^= gfMultiply(scale, previous[i]);
+        if (2 * errors <= n) {
+          errors = n + 1 - errors;
+          for (size_t i = 0; i <= kParitySize; ++i) previous[i] = scratch[i];
+          previousDiscrepancy = discrepancy;
+          shift = 1;
+        } else {
+          ++shift;
+        }
+      }
+      return errors;
+    }
+
+    void computeEvaluator(const uint8_t syndromes[], const uint8_t locator[], uint8_t evaluator[]) const {
+      // Error evaluator polynomial: syndromes * locator mod x^ParitySize
+      for (size_t i = 0; i < kParitySize; ++i) {
+        evaluator[i] = 0;
+        for (size_t j = 0; j <= i; ++j) evaluator[i] ^= gfMultiply(syndromes[j], locator[i - j]);
+      }
+    }
+};
+
+} }
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+// Standard libraries
+
+// Third-party libraries
+#include <elapsedMillis.h>
+
+// Phyllo
+
+namespace Phyllo { namespace Util {
+
+class TokenBucket {
+  public:
+    // Tokens are tracked in thousandths so that slow rates still refill on every millisecond
+    static const unsigned long kScale = 1000;
+
+    TokenBucket() {}
+
+    TokenBucket(unsigned long rate, unsigned long capacity) :
+      rate(rate), capacity(capacity), level(capacity * kScale) {}
+
+    // TokenBucket interface
+
+    bool limited() const { // a rate of zero means the bucket never runs out
+      return rate;
+    }
+
+    bool available(unsigned long tokens) {
+      if (!limited()) return true;
+
+      refill();
+      return level >= tokens * kScale;
+    }
+
+    bool consume(unsigned long tokens) {
+      if (!available(tokens)) return false;
+
+      if (limited()) level -= tokens * kScale;
+      return true;
+    }
+
+    unsigned long tokensPerSecond() const {
+      return rate;
+    }
+
+    void setRate(unsigned long rate) {
+      refill(); // tokens accumulated so far were earned at the old rate
+      this->rate = rate;
+    }
+
+    void setCapacity(unsigned long capacity) {
+      this->capacity = capacity;
+      if (level > capacity * kScale) level = capacity * kScale;
+    }
+
+  protected:
+    unsigned long rate = 0; // tokens per second
+    unsigned long capacity = 0; // maximum burst size, in tokens
+    unsigned long level = 0; // thousandths of tokens
+    elapsedMillis clock;
+
+    void refill() {
+      unsigned long elapsed = clock;
+      if (!elapsed) return;
+
+      clock = 0;
+      unsigned long room = capacity * kScale - level;
+      if (!rate || elapsed >= room / rate + 1) level = capacity * kScale; // also avoids overflow after long idle times
+      else level += elapsed * rate;
+      if (level > capacity * kScale) level = capacity * kScale;
+    }
+};
+
+} }
\ No newline at end of file